@@ -0,0 +1,143 @@
+///  @file	BoxGroups.cpp
+///  @brief	Implements class: BoxGroups
+///
+///		The groups of a --b boxes file, as x-segments of each row. See
+///     BoxGroups.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "BoxGroups.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace
+{
+	// The integers i in [0, limit) with lo < i < hi. Voxel indices convert to float exactly,
+	// so this matches the float comparisons of IsInAABox().
+	void OpenRange(const float lo, const float hi, const int limit, int& first, int& last)
+	{
+		if (std::isnan(lo) || std::isnan(hi))
+		{
+			first = 0;
+			last = -1;
+			return;
+		}
+		const double f = std::floor(static_cast<double>(lo)) + 1.0;
+		const double l = std::ceil(static_cast<double>(hi)) - 1.0;
+		first = static_cast<int>(std::min(std::max(f, 0.0), static_cast<double>(limit)));
+		last = static_cast<int>(std::max(std::min(l, static_cast<double>(limit) - 1.0), -1.0));
+	}
+}
+
+BoxGroups::BoxGroups(const std::vector<AABox>& boxes, const int width, const int height)
+: mWidth(width),
+  mHeight(height),
+  mRowValid(false)
+{
+	for (auto box = boxes.begin(); box != boxes.end(); ++box)
+	{
+		Group group;
+		group.inside = box->inside;
+		OpenRange(box->minima.x, box->maxima.x, width,   group.first[0], group.last[0]);
+		OpenRange(box->minima.y, box->maxima.y, height,  group.first[1], group.last[1]);
+		OpenRange(box->minima.z, box->maxima.z, INT_MAX, group.first[2], group.last[2]);
+		mGroups.push_back(group);
+	}
+
+	mInSlice.assign(mGroups.size(), 0);
+	mInZ.assign(mGroups.size(), 0);
+	mRowInBox.assign(mGroups.size(), 0);
+}
+
+void BoxGroups::GetFootprint(const int group, int& x0, int& y0, int& width, int& height) const
+{
+	const Group& g = mGroups[group];
+	if (!g.inside)
+	{
+		x0 = y0 = 0;
+		width = mWidth;
+		height = mHeight;
+		return;
+	}
+
+	x0 = std::min(g.first[0], mWidth);
+	y0 = std::min(g.first[1], mHeight);
+	width = std::max(g.last[0] - g.first[0] + 1, 0);
+	height = std::max(g.last[1] - g.first[1] + 1, 0);
+}
+
+void BoxGroups::BeginSlice(const int z)
+{
+	for (size_t gi = 0; gi < mGroups.size(); ++gi)
+	{
+		const Group& g = mGroups[gi];
+		mInZ[gi] = (z >= g.first[2] && z <= g.last[2]) ? 1 : 0;
+		mInSlice[gi] = (mInZ[gi] || !g.inside) ? 1 : 0;
+	}
+	mRowValid = false;
+}
+
+const std::vector<BoxGroups::Segment>& BoxGroups::GetRowSegments(const int y)
+{
+	bool changed = !mRowValid;
+	for (size_t gi = 0; gi < mGroups.size(); ++gi)
+	{
+		const Group& g = mGroups[gi];
+		const char inBox = (mInZ[gi] && y >= g.first[1] && y <= g.last[1]) ? 1 : 0;
+		changed |= (inBox != mRowInBox[gi]);
+		mRowInBox[gi] = inBox;
+	}
+
+	if (changed)
+		BuildSegments();
+	mRowValid = true;
+	return mSegments;
+}
+
+void BoxGroups::BuildSegments()
+{
+	// Every x where some group's membership can change
+	mBreaks.clear();
+	mBreaks.push_back(0);
+	mBreaks.push_back(mWidth);
+	for (size_t gi = 0; gi < mGroups.size(); ++gi)
+	{
+		const Group& g = mGroups[gi];
+		if (mRowInBox[gi] && g.first[0] <= g.last[0])
+		{
+			mBreaks.push_back(g.first[0]);
+			mBreaks.push_back(g.last[0] + 1);
+		}
+	}
+	std::sort(mBreaks.begin(), mBreaks.end());
+	mBreaks.erase(std::unique(mBreaks.begin(), mBreaks.end()), mBreaks.end());
+
+	mSegments.clear();
+	mSegmentGroups.clear();
+	for (size_t b = 0; b + 1 < mBreaks.size(); ++b)
+	{
+		// No group changes within [begin, end), so testing begin decides for the whole segment
+		Segment segment;
+		segment.begin = mBreaks[b];
+		segment.end = mBreaks[b + 1];
+		segment.firstGroup = static_cast<int>(mSegmentGroups.size());
+		for (size_t gi = 0; gi < mGroups.size(); ++gi)
+		{
+			const Group& g = mGroups[gi];
+			const bool inBox = mRowInBox[gi] && segment.begin >= g.first[0] && segment.begin <= g.last[0];
+			if (g.inside == inBox)
+				mSegmentGroups.push_back(static_cast<int>(gi));
+		}
+		segment.numGroups = static_cast<int>(mSegmentGroups.size()) - segment.firstGroup;
+		if (segment.numGroups > 0)
+			mSegments.push_back(segment);
+	}
+}
+
+// EOF
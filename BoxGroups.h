@@ -0,0 +1,89 @@
+///  @file	BoxGroups.h
+///  @brief	Implements class: BoxGroups
+///
+///		The groups of a --b boxes file. Each group is an axis-aligned box, and
+///     a voxel belongs to the group if it is strictly inside the box (or
+///     strictly outside it, for a box with inside = 0). See IsInAABox().
+///
+///		Instead of testing every voxel against every box, BoxGroups cuts each
+///     row of a slice into segments, [begin, end) runs of x that belong to the
+///     same set of groups. The mesher then scans each row once and hands the
+///     foreground voxels of a segment to all of the segment's groups.
+///     Segments only change where a row enters or leaves a box in y or z, so
+///     they are rebuilt only for those rows.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <vector>
+#include "VertPool.h" // Vec3
+
+struct AABox
+{
+	Vec3 minima;
+	Vec3 maxima;
+	bool inside;
+};
+
+inline bool IsInAABox(const Vec3& p, const AABox& box)
+{
+	const bool i = (p.x > box.minima.x && p.x < box.maxima.x &&
+					p.y > box.minima.y && p.y < box.maxima.y &&
+					p.z > box.minima.z && p.z < box.maxima.z);
+	return (box.inside ? i : !i);
+}
+
+class BoxGroups
+{
+public:
+	struct Segment
+	{
+		int begin;          // x range [begin, end)
+		int end;
+		int firstGroup;     // the segment's groups are GetGroups()[firstGroup, firstGroup + numGroups), ascending
+		int numGroups;
+	};
+
+	BoxGroups(const std::vector<AABox>& boxes, const int width, const int height);
+
+	int GetNumGroups() const { return static_cast<int>(mGroups.size()); }
+
+	// The voxels (x0, y0) to (x0 + width - 1, y0 + height - 1) that the group can contain in any slice
+	void GetFootprint(const int group, int& x0, int& y0, int& width, int& height) const;
+
+	void BeginSlice(const int z);
+	bool IsInSlice(const int group) const { return mInSlice[group] != 0; }
+
+	// Segments of row y of the current slice that belong to at least one group, in ascending x
+	const std::vector<Segment>& GetRowSegments(const int y);
+	const int* GetGroups() const { return mSegmentGroups.data(); }
+
+protected:
+	// The voxels strictly inside a box along each axis, as inclusive index ranges (empty if first > last)
+	struct Group
+	{
+		bool inside;
+		int first[3];
+		int last[3];
+	};
+
+	void BuildSegments();
+
+	std::vector<Group> mGroups;
+	const int mWidth;
+	const int mHeight;
+
+	std::vector<char> mInSlice;     // per group: can the group have voxels in the current slice?
+	std::vector<char> mInZ;         // per group: is the current slice within the box in z?
+	std::vector<char> mRowInBox;    // per group: is the current row within the box in y and z?
+	bool mRowValid;                 // mRowInBox and the segments are up to date for some row of this slice
+
+	std::vector<Segment> mSegments;
+	std::vector<int> mSegmentGroups;
+	std::vector<int> mBreaks;       // scratch for BuildSegments()
+};
@@ -0,0 +1,126 @@
+///  @file	Checkpoint.cpp
+///  @brief	Checkpoints of a conversion in progress, for --resume
+///
+///		See Checkpoint.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "Checkpoint.h"
+
+#include <cstring>
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include "Fnv1a.h"
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+	const char kMagic[8] = { 'B', '2', 'V', 'C', 'H', 'K', 'P', 'T' };
+}
+
+CheckpointHeader MakeCheckpointHeader(const int width, const int height, const int depth, const int numGroups,
+									  const short threshold, const bool negate,
+									  const uint64_t fingerprint, const uint64_t settings)
+{
+	CheckpointHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version = kCheckpointVersion;
+	header.endianTag = kCheckpointEndianTag;
+	header.dims[0] = static_cast<uint32_t>(width);
+	header.dims[1] = static_cast<uint32_t>(height);
+	header.dims[2] = static_cast<uint32_t>(depth);
+	header.numGroups = static_cast<uint32_t>(numGroups);
+	header.threshold = threshold;
+	header.negate = negate ? 1 : 0;
+	header.fingerprint = fingerprint;
+	header.settings = settings;
+	return header;
+}
+
+uint64_t CheckpointSettingsHash(const std::string& format, const std::vector<short>& thresholds,
+								const int coarsen, const double coarsenFraction, const std::vector<AABox>& boxes,
+								const uint64_t minComponentSize, const bool keepLargest, const std::string& renumber)
+{
+	uint64_t hash = Fnv1a(kFnv1aSeed, format.data(), format.size());
+	hash = Fnv1a(hash, thresholds.data(), thresholds.size() * sizeof(short));
+	hash = Fnv1a(hash, &coarsen, sizeof(coarsen));
+	hash = Fnv1a(hash, &coarsenFraction, sizeof(coarsenFraction));
+	for (auto box = boxes.begin(); box != boxes.end(); ++box)
+	{
+		const float values[6] = { box->minima.x, box->minima.y, box->minima.z,
+								  box->maxima.x, box->maxima.y, box->maxima.z };
+		const unsigned char inside = box->inside ? 1 : 0;
+		hash = Fnv1a(hash, values, sizeof(values));
+		hash = Fnv1a(hash, &inside, sizeof(inside));
+	}
+	const unsigned char largest = keepLargest ? 1 : 0;
+	hash = Fnv1a(hash, &minComponentSize, sizeof(minComponentSize));
+	hash = Fnv1a(hash, &largest, sizeof(largest));
+	hash = Fnv1a(hash, renumber.data(), renumber.size());
+	return hash;
+}
+
+bool WriteCheckpoint(const std::string& filename, const CheckpointHeader& header,
+					 const std::vector<CheckpointGroup>& groups, const std::vector<LatticeNodePool>& pools)
+{
+	const std::string tempFilename = filename + ".tmp";
+	{
+		std::ofstream file(tempFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(groups.data()), groups.size() * sizeof(CheckpointGroup));
+		for (auto pool = pools.begin(); pool != pools.end(); ++pool)
+			pool->WriteState(file);
+		file.close();
+		if (!file)
+		{
+			boost::system::error_code ignored;
+			fs::remove(fs::path(tempFilename), ignored);
+			return false;
+		}
+	}
+
+	boost::system::error_code ec;
+	fs::rename(fs::path(tempFilename), fs::path(filename), ec);
+	return !ec;
+}
+
+bool ReadCheckpoint(const std::string& filename, CheckpointHeader& header,
+					std::vector<CheckpointGroup>& groups, std::vector<LatticeNodePool>& pools)
+{
+	std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+	CheckpointHeader saved;
+	file.read(reinterpret_cast<char*>(&saved), sizeof(saved));
+	if (!file)
+		return false;
+
+	// Everything but the progress has to match
+	CheckpointHeader identity = saved;
+	identity.nextSlice = 0;
+	identity.elementCount = 0;
+	identity.reserved = 0;
+	if (memcmp(&identity, &header, sizeof(header)) != 0 || saved.nextSlice > saved.dims[2] ||
+		pools.size() != header.numGroups)
+		return false;
+
+	groups.resize(header.numGroups);
+	file.read(reinterpret_cast<char*>(groups.data()), groups.size() * sizeof(CheckpointGroup));
+	for (auto pool = pools.begin(); pool != pools.end() && file; ++pool)
+	{
+		if (!pool->ReadState(file))
+			return false;
+	}
+	if (!file)
+		return false;
+
+	header.nextSlice = saved.nextSlice;
+	header.elementCount = saved.elementCount;
+	return true;
+}
+
+// EOF
@@ -0,0 +1,77 @@
+///  @file	Checkpoint.h
+///  @brief	Checkpoints of a conversion in progress, for --resume
+///
+///		Nodes and elements are written as soon as each slice is meshed, so
+///     everything a run needs to carry on from slice z is small: the element
+///     count, how many bytes of each output file are complete, and the two
+///     planes of node IDs held by each group's LatticeNodePool.
+///
+///		A checkpoint is a CheckpointHeader, one CheckpointGroup per group,
+///     then each pool's LatticeNodePool::WriteState(). It is written to a
+///     temporary file and renamed into place, so a run killed while writing
+///     one still leaves the previous checkpoint intact.
+///
+///		The header identifies the run it belongs to: the bitmaps (as for the
+///     occupancy cache), the stack size, thresholds, negate flag, output
+///     format, coarsening and boxes. In a threshold sweep, every threshold's groups are
+///     checkpointed together, threshold by threshold. Resuming with anything else fails rather than
+///     producing output that doesn't match an uninterrupted run.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "LatticeNodePool.h"
+#include "BoxGroups.h" // AABox
+
+struct CheckpointHeader
+{
+	char     magic[8];          // "B2VCHKPT"
+	uint32_t version;           // kCheckpointVersion
+	uint32_t endianTag;         // kCheckpointEndianTag, as written by the producer
+	uint32_t dims[3];           // stack width, height and depth in voxels
+	uint32_t numGroups;         // over all thresholds
+	int32_t  threshold;         // the first, in a sweep
+	uint32_t negate;
+	uint64_t fingerprint;       // see OccupancyCacheFingerprint()
+	uint64_t settings;          // see CheckpointSettingsHash()
+	uint64_t nextSlice;         // slices (of the coarse lattice, with --coarsen) before this one are complete
+	uint64_t elementCount;      // elements written so far, over all groups
+	uint64_t reserved;
+};
+
+static_assert(sizeof(CheckpointHeader) == 80, "CheckpointHeader must stay 80 bytes");
+
+struct CheckpointGroup
+{
+	uint64_t nodesBytes;        // complete length of the group's nodes file
+	uint64_t indicesBytes;      // complete length of the group's indices file
+	uint64_t elementCount;      // elements written to the group's indices file
+};
+
+const uint32_t kCheckpointVersion   = 2;
+const uint32_t kCheckpointEndianTag = 0x01020304;
+
+// A header identifying a run. nextSlice and elementCount are 0.
+CheckpointHeader MakeCheckpointHeader(const int width, const int height, const int depth, const int numGroups,
+									  const short threshold, const bool negate,
+									  const uint64_t fingerprint, const uint64_t settings);
+
+// Hash of the options, besides the bitmaps, that change the output
+uint64_t CheckpointSettingsHash(const std::string& format, const std::vector<short>& thresholds,
+								const int coarsen, const double coarsenFraction, const std::vector<AABox>& boxes,
+								const uint64_t minComponentSize, const bool keepLargest, const std::string& renumber);
+
+bool WriteCheckpoint(const std::string& filename, const CheckpointHeader& header,
+					 const std::vector<CheckpointGroup>& groups, const std::vector<LatticeNodePool>& pools);
+
+// Fails unless the checkpoint matches header (apart from nextSlice and elementCount, which are filled in)
+bool ReadCheckpoint(const std::string& filename, CheckpointHeader& header,
+					std::vector<CheckpointGroup>& groups, std::vector<LatticeNodePool>& pools);
@@ -0,0 +1,182 @@
+///  @file	ComponentFilter.cpp
+///  @brief	Implements class: ComponentFilter
+///
+///		Drops small connected components of the foreground. See ComponentFilter.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "ComponentFilter.h"
+
+#include <algorithm>
+
+const ComponentFilter::Label ComponentFilter::kNoLabel;
+
+ComponentFilter::ComponentFilter()
+: mSecondPass(false),
+  mNextLabel(0),
+  mNumComponents(0),
+  mNumKept(0),
+  mVoxelsDropped(0)
+{
+	mPrev.z = mCurrent.z = -2;  // never the slice before the first
+}
+
+void ComponentFilter::AddSlice(const OccupancySlice& slice)
+{
+	LabelSlice(slice);
+}
+
+void ComponentFilter::SelectComponents(const uint64_t minSize, const bool keepLargest)
+{
+	const Label numLabels = static_cast<Label>(mParent.size());
+	Label largest = kNoLabel;
+	mNumComponents = 0;
+	for (Label label = 0; label < numLabels; ++label)
+	{
+		if (mParent[label] != label)
+			continue;
+		++mNumComponents;
+		if (largest == kNoLabel || mSize[label] > mSize[largest])
+			largest = label;
+	}
+
+	// Roots first, then every other label takes its root's decision, so the second pass needs no Find()
+	mKeep.assign(numLabels, 0);
+	mNumKept = 0;
+	mVoxelsDropped = 0;
+	for (Label label = 0; label < numLabels; ++label)
+	{
+		if (mParent[label] != label)
+			continue;
+		if (mSize[label] >= minSize && (!keepLargest || label == largest))
+		{
+			mKeep[label] = 1;
+			++mNumKept;
+		}
+		else
+			mVoxelsDropped += mSize[label];
+	}
+	for (Label label = 0; label < numLabels; ++label)
+		mKeep[label] = mKeep[Find(label)];
+
+	std::vector<uint64_t>().swap(mSize);
+	std::vector<Label>().swap(mParent);
+	mSecondPass = true;
+	Rewind();
+}
+
+void ComponentFilter::Rewind()
+{
+	mNextLabel = 0;
+	mPrev.z = mCurrent.z = -2;
+}
+
+void ComponentFilter::FilterSlice(OccupancySlice& slice)
+{
+	LabelSlice(slice);
+	if (mCurrent.runs.empty())
+		return;
+
+	bool cleared = false;
+	const int height = slice.GetHeight();
+	for (int y = 0; y < height; ++y)
+	{
+		for (int r = mCurrent.rowFirstRun[y]; r < mCurrent.rowFirstRun[y + 1]; ++r)
+		{
+			const Run& run = mCurrent.runs[r];
+			if (!mKeep[run.label])
+			{
+				slice.ClearBits(y, run.begin, run.end);
+				cleared = true;
+			}
+		}
+	}
+	if (cleared)
+		slice.UpdateSummary();
+}
+
+void ComponentFilter::LabelSlice(const OccupancySlice& slice)
+{
+	std::swap(mPrev, mCurrent);
+	mCurrent.z = slice.z;
+	mCurrent.runs.clear();
+	mCurrent.rowFirstRun.clear();
+	if (slice.status != OccupancySlice::kOk || slice.IsEmpty())
+		return;
+
+	// Runs only join the slice before if it is the one directly below
+	const bool joinPrev = mPrev.z == slice.z - 1 && !mPrev.runs.empty();
+	const int width = slice.GetWidth();
+	const int height = slice.GetHeight();
+	mCurrent.rowFirstRun.resize(height + 1);
+	for (int y = 0; y < height; ++y)
+	{
+		const int rowFirst = static_cast<int>(mCurrent.runs.size());
+		mCurrent.rowFirstRun[y] = rowFirst;
+
+		mRowRuns.clear();
+		slice.AppendRuns(y, 64 * slice.GetRowFirstWord(y), std::min(64 * slice.GetRowEndWord(y), width), mRowRuns);
+		if (mRowRuns.empty())
+			continue;
+
+		// The runs of the row before, and of this row in the slice before, are walked alongside this row's
+		int above = (y > 0) ? mCurrent.rowFirstRun[y - 1] : 0;
+		const int aboveEnd = rowFirst;
+		int below = joinPrev ? mPrev.rowFirstRun[y] : 0;
+		const int belowEnd = joinPrev ? mPrev.rowFirstRun[y + 1] : 0;
+		for (size_t i = 0; i < mRowRuns.size(); i += 2)
+		{
+			Run run = { mRowRuns[i], mRowRuns[i + 1], kNoLabel };
+			while (above < aboveEnd && mCurrent.runs[above].end <= run.begin)
+				++above;
+			for (int j = above; j < aboveEnd && mCurrent.runs[j].begin < run.end; ++j)
+				Join(run.label, mCurrent.runs[j].label);
+			while (below < belowEnd && mPrev.runs[below].end <= run.begin)
+				++below;
+			for (int j = below; j < belowEnd && mPrev.runs[j].begin < run.end; ++j)
+				Join(run.label, mPrev.runs[j].label);
+
+			// A run that overlaps nothing before it starts a label. Both passes start the same ones, in the same order.
+			if (run.label == kNoLabel)
+			{
+				run.label = mNextLabel++;
+				if (!mSecondPass)
+				{
+					mParent.push_back(run.label);
+					mSize.push_back(0);
+				}
+			}
+			if (!mSecondPass)
+				mSize[Find(run.label)] += run.end - run.begin;
+			mCurrent.runs.push_back(run);
+		}
+	}
+	mCurrent.rowFirstRun[height] = static_cast<int>(mCurrent.runs.size());
+}
+
+void ComponentFilter::Join(Label& label, const Label other)
+{
+	if (label == kNoLabel)
+	{
+		label = other;
+		return;
+	}
+	if (mSecondPass)
+		return;
+
+	// Union by size, so the trees stay shallow
+	Label a = Find(label);
+	Label b = Find(other);
+	if (a == b)
+		return;
+	if (mSize[a] < mSize[b])
+		std::swap(a, b);
+	mParent[b] = a;
+	mSize[a] += mSize[b];
+}
+
+// EOF
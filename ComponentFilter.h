@@ -0,0 +1,103 @@
+///  @file	ComponentFilter.h
+///  @brief	Implements class: ComponentFilter
+///
+///		Drops the connected components of the foreground that are too small
+///     to mesh, for --keep-largest and --min-component-size. Noise in the
+///     stack leaves clusters of voxels that touch nothing else, and every
+///     one of them makes the stiffness matrix singular.
+///
+///		Voxels are connected if they share a face. The stack is read twice.
+///     The first pass (AddSlice()) labels the runs of each row of each
+///     slice with a union-find: a run joins the runs it overlaps in the row
+///     before and in the same row of the slice before, so only the runs of
+///     two slices are held at a time. Label equivalences carry across slices
+///     in the union-find, which has one entry per run that starts a new
+///     label (one that overlaps no earlier run), rather than one per voxel.
+///
+///		SelectComponents() then decides which components are kept. The
+///     second pass (FilterSlice()) labels the slices again, which gives
+///     every run the same labels as the first pass, and clears the runs of
+///     the components that were dropped.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "OccupancySlice.h"
+
+class ComponentFilter
+{
+public:
+	ComponentFilter();
+
+	// First pass: adds the next slice, by slice.z. Slices that are skipped, or weren't read, are background.
+	void AddSlice(const OccupancySlice& slice);
+
+	// Keeps the components of at least minSize voxels, and only the largest of them if keepLargest
+	// (the first found, of equal sizes). Call once every slice has been added.
+	void SelectComponents(const uint64_t minSize, const bool keepLargest);
+
+	// Second pass: clears the voxels of the dropped components from the next slice, by slice.z
+	void FilterSlice(OccupancySlice& slice);
+
+	// Starts the second pass again from the first slice, for a stack that is read once more
+	void Rewind();
+
+	uint64_t GetNumComponents() const { return mNumComponents; }
+	uint64_t GetNumKept() const { return mNumKept; }
+	uint64_t GetVoxelsDropped() const { return mVoxelsDropped; }
+
+protected:
+	typedef uint64_t Label;     // a noisy stack of billions of voxels can start more than 2^32 labels
+	static const Label kNoLabel = ~static_cast<Label>(0);
+
+	struct Run
+	{
+		int begin, end;
+		Label label;
+	};
+
+	// The runs of a slice, and where each row's runs start
+	struct SliceRuns
+	{
+		int z;
+		std::vector<Run> runs;
+		std::vector<int> rowFirstRun;   // per row, and one past the last row
+	};
+
+	// Labels the runs of slice into mCurrent, against the slice before in mPrev
+	void LabelSlice(const OccupancySlice& slice);
+	void Join(Label& label, const Label other);
+	inline Label Find(Label label);
+
+	std::vector<Label> mParent;     // per label
+	std::vector<uint64_t> mSize;    // per label, voxels of the component it is the root of (first pass)
+	std::vector<unsigned char> mKeep;   // per label (second pass)
+	bool mSecondPass;
+	Label mNextLabel;
+
+	SliceRuns mPrev;
+	SliceRuns mCurrent;
+	std::vector<int> mRowRuns;      // (begin, end) pairs of the row being labelled
+
+	uint64_t mNumComponents;
+	uint64_t mNumKept;
+	uint64_t mVoxelsDropped;
+};
+
+ComponentFilter::Label ComponentFilter::Find(Label label)
+{
+	// Path halving
+	while (mParent[label] != label)
+	{
+		mParent[label] = mParent[mParent[label]];
+		label = mParent[label];
+	}
+	return label;
+}
@@ -0,0 +1,418 @@
+///  @file	DomainPartitioner.cpp
+///  @brief	Implements class: DomainPartitioner
+///
+///		Splits the lattice into partitions and maps their interfaces. See
+///     DomainPartitioner.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "DomainPartitioner.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+const uint64_t DomainPartitioner::kMaxBins;
+
+namespace
+{
+	const size_t kSortBytes = static_cast<size_t>(256) << 20;   // held in memory by each sort
+	const size_t kChunkRecords = 1 << 16;                       // interface records formatted at a time
+
+	// An interface node of a partition, by its owner's copy of it, and another partition it is shared with
+	struct Link
+	{
+		uint32_t owner;
+		uint64_t ownerLocalId;
+		uint32_t partition;
+		uint64_t localId;
+		uint32_t other;
+
+		bool operator<(const Link& l) const
+		{
+			if (owner != l.owner)
+				return owner < l.owner;
+			if (ownerLocalId != l.ownerLocalId)
+				return ownerLocalId < l.ownerLocalId;
+			if (partition != l.partition)
+				return partition < l.partition;
+			return other < l.other;
+		}
+	};
+
+	// A node of a partition, which another partition owns
+	struct NotOwned
+	{
+		uint32_t partition;
+		uint64_t localId;
+
+		bool operator<(const NotOwned& n) const { return partition < n.partition || (partition == n.partition && localId < n.localId); }
+	};
+
+	// A record of a partition's interface map
+	struct InterfaceRecord
+	{
+		uint32_t partition;
+		uint64_t localId;
+		uint32_t other;
+		uint64_t globalId;
+
+		bool operator<(const InterfaceRecord& r) const
+		{
+			if (partition != r.partition)
+				return partition < r.partition;
+			if (localId != r.localId)
+				return localId < r.localId;
+			return other < r.other;
+		}
+	};
+
+	uint32_t LatticeCoordinate(const float position, const float spacing)
+	{
+		return static_cast<uint32_t>(std::max(0L, std::lround(position / spacing)));
+	}
+}
+
+DomainPartitioner::DomainPartitioner(const int numPartitions, const int width, const int height, const int depth, const float spacing,
+									 const std::string& tempPrefix)
+: mNumPartitions(numPartitions),
+  mSpacing(spacing),
+  mTempPrefix(tempPrefix),
+  mBinSize(1),
+  mFirst(3 * numPartitions, 0),
+  mEnd(3 * numPartitions, 0),
+  mFirstGlobalIds(numPartitions, 0),
+  mInterfaceNodeCounts(numPartitions, 0)
+{
+	mDims[0] = width;
+	mDims[1] = height;
+	mDims[2] = depth;
+
+	// The smallest cubes of voxels that bring the bins under kMaxBins
+	for (;; ++mBinSize)
+	{
+		for (int a = 0; a < 3; ++a)
+			mBinDims[a] = std::max((mDims[a] + mBinSize - 1) / mBinSize, 1);
+		if (static_cast<uint64_t>(mBinDims[0]) * mBinDims[1] * mBinDims[2] <= kMaxBins)
+			break;
+	}
+	mBins.assign(static_cast<size_t>(mBinDims[0]) * mBinDims[1] * mBinDims[2], 0);
+}
+
+void DomainPartitioner::AddSlice(const OccupancySlice& slice)
+{
+	if (slice.status != OccupancySlice::kOk || slice.IsEmpty())
+		return;
+
+	const int bz = slice.z / mBinSize;
+	int minX, minY, maxX, maxY;
+	slice.GetBounds(minX, minY, maxX, maxY);
+	for (int y = minY; y <= maxY; ++y)
+	{
+		mRuns.clear();
+		slice.AppendRuns(y, 64 * slice.GetRowFirstWord(y), std::min(64 * slice.GetRowEndWord(y), mDims[0]), mRuns);
+		uint32_t* const row = &mBins[BinIndex(0, y / mBinSize, bz)];
+		for (size_t r = 0; r < mRuns.size(); r += 2)
+		{
+			// A run's voxels go to each bin it crosses
+			for (int x = mRuns[r]; x < mRuns[r + 1];)
+			{
+				const int bx = x / mBinSize;
+				const int binEnd = std::min((bx + 1) * mBinSize, mRuns[r + 1]);
+				row[bx] += binEnd - x;
+				x = binEnd;
+			}
+		}
+	}
+}
+
+void DomainPartitioner::Bisect()
+{
+	const int first[3] = { 0, 0, 0 };
+	Split(first, mBinDims, 0, mNumPartitions);
+	std::vector<uint32_t>().swap(mBins);
+
+	// Bins to voxels. The last bin on each axis may be cut short by the edge of the lattice.
+	for (size_t i = 0; i < mFirst.size(); ++i)
+	{
+		mFirst[i] = std::min(mFirst[i] * mBinSize, mDims[i % 3]);
+		mEnd[i] = std::min(mEnd[i] * mBinSize, mDims[i % 3]);
+	}
+	mFaceNodes.reset(new ExternalSorter<FaceNode>(mTempPrefix + ".faces", kSortBytes / sizeof(FaceNode)));
+}
+
+void DomainPartitioner::Split(const int first[3], const int end[3], const int firstPartition, const int numPartitions)
+{
+	if (numPartitions == 1)
+	{
+		std::copy(first, first + 3, &mFirst[3 * firstPartition]);
+		std::copy(end, end + 3, &mEnd[3 * firstPartition]);
+		return;
+	}
+
+	// The foreground of each plane of bins of the box, along each axis
+	std::vector<uint64_t> planes[3];
+	for (int a = 0; a < 3; ++a)
+		planes[a].assign(std::max(end[a] - first[a], 0), 0);
+	uint64_t total = 0;
+	for (int bz = first[2]; bz < end[2]; ++bz)
+	{
+		for (int by = first[1]; by < end[1]; ++by)
+		{
+			const uint32_t* const row = &mBins[BinIndex(0, by, bz)];
+			uint64_t rowTotal = 0;
+			for (int bx = first[0]; bx < end[0]; ++bx)
+			{
+				planes[0][bx - first[0]] += row[bx];
+				rowTotal += row[bx];
+			}
+			planes[1][by - first[1]] += rowTotal;
+			planes[2][bz - first[2]] += rowTotal;
+			total += rowTotal;
+		}
+	}
+
+	// Cut across the longest axis of the box's foreground (or of the box, if it has none) that can be cut
+	int axis = -1;
+	int axisLength = 0;
+	for (int a = 0; a < 3; ++a)
+	{
+		if (end[a] - first[a] < 2)
+			continue;
+		int lo = 0;
+		int hi = end[a] - first[a];
+		if (total > 0)
+		{
+			while (planes[a][lo] == 0)
+				++lo;
+			while (planes[a][hi - 1] == 0)
+				--hi;
+		}
+		if (hi - lo > axisLength)
+		{
+			axis = a;
+			axisLength = hi - lo;
+		}
+	}
+
+	// The first numLeft partitions go below the cut, with their share of the foreground
+	const int numLeft = numPartitions / 2;
+	int cut = end[0];
+	if (axis >= 0)
+	{
+		const int length = end[axis] - first[axis];
+		if (total == 0)
+			cut = first[axis] + length / 2;
+		else
+		{
+			// The plane boundary whose foreground below is closest to the share, leaving a plane on either side
+			const double target = static_cast<double>(total) * numLeft / numPartitions;
+			uint64_t below = planes[axis][0];
+			int best = 1;
+			double bestError = std::fabs(below - target);
+			for (int c = 2; c < length; ++c)
+			{
+				below += planes[axis][c - 1];
+				const double error = std::fabs(below - target);
+				if (error < bestError)
+				{
+					best = c;
+					bestError = error;
+				}
+			}
+			cut = first[axis] + best;
+		}
+	}
+	else
+		axis = 0;   // a single bin can't be cut, so the partitions above the cut are empty
+
+	int leftEnd[3] = { end[0], end[1], end[2] };
+	int rightFirst[3] = { first[0], first[1], first[2] };
+	leftEnd[axis] = cut;
+	rightFirst[axis] = cut;
+	Split(first, leftEnd, firstPartition, numLeft);
+	Split(rightFirst, end, firstPartition + numLeft, numPartitions - numLeft);
+}
+
+void DomainPartitioner::GetPartition(const int partition, int first[3], int end[3]) const
+{
+	std::copy(&mFirst[3 * partition], &mFirst[3 * partition] + 3, first);
+	std::copy(&mEnd[3 * partition], &mEnd[3 * partition] + 3, end);
+}
+
+std::vector<AABox> DomainPartitioner::GetBoxes() const
+{
+	// A box holds the voxels strictly inside it, so voxels [first, end) are inside (first - 1/2, end - 1/2)
+	std::vector<AABox> boxes;
+	for (int p = 0; p < mNumPartitions; ++p)
+	{
+		const int* const first = &mFirst[3 * p];
+		const int* const end = &mEnd[3 * p];
+		AABox box = { Vec3(first[0] - 0.5f, first[1] - 0.5f, first[2] - 0.5f),
+					  Vec3(end[0] - 0.5f, end[1] - 0.5f, end[2] - 0.5f), true };
+		boxes.push_back(box);
+	}
+	return boxes;
+}
+
+bool DomainPartitioner::AddNodes(const int partition, const uint64_t firstId, const Vec3* nodes, const size_t count)
+{
+	// Nodes at [first, end] on each axis are the partition's, and those at a bound that isn't the edge of the lattice are on a shared face
+	const int* const first = &mFirst[3 * partition];
+	const int* const end = &mEnd[3 * partition];
+	uint32_t shared[3][2];
+	for (int a = 0; a < 3; ++a)
+	{
+		shared[a][0] = (first[a] > 0) ? static_cast<uint32_t>(first[a]) : ~0u;
+		shared[a][1] = (end[a] < mDims[a]) ? static_cast<uint32_t>(end[a]) : ~0u;
+	}
+
+	bool added = true;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint32_t x = LatticeCoordinate(nodes[i].x, mSpacing);
+		const uint32_t y = LatticeCoordinate(nodes[i].y, mSpacing);
+		const uint32_t z = LatticeCoordinate(nodes[i].z, mSpacing);
+		if (x != shared[0][0] && x != shared[0][1] && y != shared[1][0] && y != shared[1][1] &&
+			z != shared[2][0] && z != shared[2][1])
+			continue;
+
+		FaceNode node;
+		node.point = x + (static_cast<uint64_t>(mDims[0]) + 1) * (y + (static_cast<uint64_t>(mDims[1]) + 1) * z);
+		node.localId = firstId + i;
+		node.partition = static_cast<uint32_t>(partition);
+		added = mFaceNodes->Add(node) && added;
+	}
+	return added;
+}
+
+bool DomainPartitioner::WriteInterfaces(const std::vector<uint64_t>& nodeCounts, MeshFormat& format, const std::vector<std::string>& filenames)
+{
+	// Face nodes at the same lattice point are copies of one interface node, which the lowest partition owns
+	ExternalSorter<Link> links(mTempPrefix + ".links", kSortBytes / sizeof(Link));
+	ExternalSorter<NotOwned> notOwned(mTempPrefix + ".notowned", kSortBytes / sizeof(NotOwned));
+	std::vector<uint64_t> notOwnedCounts(mNumPartitions, 0);
+	std::vector<FaceNode> copies;
+	bool sorted = true;
+	auto addCopies = [&]() {
+		for (size_t m = 0; m < copies.size() && copies.size() > 1; ++m)
+		{
+			const FaceNode& copy = copies[m];
+			++mInterfaceNodeCounts[copy.partition];
+			if (m > 0)
+			{
+				const NotOwned node = { copy.partition, copy.localId };
+				sorted = notOwned.Add(node) && sorted;
+				++notOwnedCounts[copy.partition];
+			}
+			for (size_t o = 0; o < copies.size(); ++o)
+			{
+				const Link link = { copies[0].partition, copies[0].localId, copy.partition, copy.localId, copies[o].partition };
+				if (o != m)
+					sorted = links.Add(link) && sorted;
+			}
+		}
+		copies.clear();
+	};
+	sorted = mFaceNodes->Merge([&](const FaceNode& node) {
+		if (!copies.empty() && copies[0].point != node.point)
+			addCopies();
+		copies.push_back(node);
+	}) && sorted;
+	addCopies();
+	mFaceNodes.reset();
+
+	// Each partition's owned nodes are numbered on from those of the partitions before it
+	uint64_t globalId = 0;
+	for (int p = 0; p < mNumPartitions; ++p)
+	{
+		mFirstGlobalIds[p] = globalId;
+		globalId += nodeCounts[p] - notOwnedCounts[p];
+	}
+
+	// A node's global ID is its owner's first, plus the number of the owner's nodes before it that the owner
+	// owns. The nodes it doesn't own are read back in order alongside the links, which are in owner order.
+	const std::string notOwnedFilename = mTempPrefix + ".notowned";
+	{
+		std::ofstream file(notOwnedFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		sorted = notOwned.Merge([&](const NotOwned& node) {
+			file.write(reinterpret_cast<const char*>(&node), sizeof(node));
+		}) && sorted && file.good();
+	}
+	ExternalSorter<InterfaceRecord> records(mTempPrefix + ".records", kSortBytes / sizeof(InterfaceRecord));
+	{
+		std::ifstream file(notOwnedFilename.c_str(), std::ios::in | std::ios::binary);
+		NotOwned next = { 0, 0 };
+		bool haveNext = file.read(reinterpret_cast<char*>(&next), sizeof(next)).good();
+		uint32_t belowPartition = 0;
+		uint64_t below = 0;     // of belowPartition's nodes it doesn't own, those read so far
+		sorted = links.Merge([&](const Link& link) {
+			const NotOwned owner = { link.owner, link.ownerLocalId };
+			while (haveNext && next < owner)
+			{
+				if (next.partition != belowPartition)
+				{
+					belowPartition = next.partition;
+					below = 0;
+				}
+				++below;
+				haveNext = file.read(reinterpret_cast<char*>(&next), sizeof(next)).good();
+			}
+			const InterfaceRecord record = { link.partition, link.localId, link.other,
+											 mFirstGlobalIds[link.owner] + link.ownerLocalId - ((belowPartition == link.owner) ? below : 0) };
+			sorted = records.Add(record) && sorted;
+		}) && sorted;
+	}
+	std::remove(notOwnedFilename.c_str());
+
+	// Each partition's records, in order of local ID, to its interface map
+	std::ofstream file;
+	int partition = -1;
+	uint64_t recordCount = 0;
+	std::vector<VertIdType> values;
+	std::string block;
+	bool written = true;
+	auto flush = [&]() {
+		block.clear();
+		format.AppendInterface(block, values.data(), values.size() / kInterfaceValues);
+		file.write(block.data(), block.size());
+		values.clear();
+	};
+	auto openNext = [&]() {
+		if (partition >= 0)
+		{
+			flush();
+			format.EndInterface(file, recordCount);
+			file.close();
+			written = written && !file.fail();
+		}
+		++partition;
+		recordCount = 0;
+		if (partition < mNumPartitions)
+		{
+			file.open(filenames[partition].c_str(), format.GetOpenMode());
+			format.BeginInterface(file);
+		}
+	};
+	openNext();
+	sorted = records.Merge([&](const InterfaceRecord& record) {
+		while (static_cast<int>(record.partition) > partition)
+			openNext();
+		values.push_back(record.localId);
+		values.push_back(record.globalId);
+		values.push_back(record.other);
+		++recordCount;
+		if (values.size() == kChunkRecords * kInterfaceValues)
+			flush();
+	}) && sorted;
+	while (partition < mNumPartitions)
+		openNext();
+	return sorted && written;
+}
+
+// EOF
@@ -0,0 +1,115 @@
+///  @file	DomainPartitioner.h
+///  @brief	Implements class: DomainPartitioner
+///
+///		Splits the lattice into subdomains for a distributed solver, for
+///     --partitions. A first pass over the stack (AddSlice()) counts the
+///     foreground voxels of each bin of the lattice, and Bisect() cuts it by
+///     recursive coordinate bisection: each box is cut across its longest
+///     axis, where the elements on either side are in proportion to the
+///     number of partitions each side is given. Every partition is a box,
+///     so the mesher meshes them as it does the boxes of a --b file, each
+///     into its own node and element files with its own node IDs.
+///
+///		The bins are single voxels unless the lattice has more than
+///     kMaxBins voxels, when they are the smallest cubes that bring it under
+///     that. Cuts fall between bins.
+///
+///		While meshing, each partition's nodes on the faces it shares with
+///     other partitions are handed to AddNodes(). Once the mesh is done,
+///     WriteInterfaces() sorts them by lattice point, and a point that more
+///     than one partition has a node at is an interface node. It is owned
+///     by the lowest of those partitions. Global node IDs number the nodes
+///     each partition owns, partition by partition, in the order of their
+///     local IDs. Each partition's interface map has a record per interface
+///     node and partition it shares the node with: the local ID, the global
+///     ID, and the other partition. The sorts are external (ExternalSorter),
+///     so the interfaces of a mesh bigger than memory are found the same way.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "OccupancySlice.h"
+#include "BoxGroups.h"  // AABox
+#include "MeshFormat.h"
+#include "ExternalSorter.h"
+
+class DomainPartitioner
+{
+public:
+	static const uint64_t kMaxBins = 1 << 24;
+
+	// A lattice of width x height x depth voxels, with nodes at spacing * (x, y, z). Temporary files are named
+	// tempPrefix followed by a suffix, and removed.
+	DomainPartitioner(const int numPartitions, const int width, const int height, const int depth, const float spacing,
+					  const std::string& tempPrefix);
+
+	int GetNumPartitions() const { return mNumPartitions; }
+
+	// First pass: counts the foreground of the next slice, by slice.z. Slices that weren't read are background.
+	void AddSlice(const OccupancySlice& slice);
+
+	// Cuts the lattice into the partitions. Call once every slice has been added.
+	void Bisect();
+
+	// The voxels [first, end) of a partition, on each axis, and the same as boxes for BoxGroups
+	void GetPartition(const int partition, int first[3], int end[3]) const;
+	std::vector<AABox> GetBoxes() const;
+
+	// While meshing: a partition's nodes with IDs from firstId, of which those on a shared face are kept.
+	// Returns false if they couldn't be written to a temporary file.
+	bool AddNodes(const int partition, const uint64_t firstId, const Vec3* nodes, const size_t count);
+
+	// Once meshed: numbers the nodes globally, given each partition's node count, and writes each partition's
+	// interface map to filenames[partition] with format. Returns false if a file can't be written or read back.
+	bool WriteInterfaces(const std::vector<uint64_t>& nodeCounts, MeshFormat& format, const std::vector<std::string>& filenames);
+
+	// The global ID of a partition's first owned node, and its number of interface nodes
+	uint64_t GetFirstGlobalId(const int partition) const { return mFirstGlobalIds[partition]; }
+	uint64_t GetInterfaceNodeCount(const int partition) const { return mInterfaceNodeCounts[partition]; }
+
+protected:
+	DomainPartitioner(const DomainPartitioner&);            // not copyable
+	DomainPartitioner& operator=(const DomainPartitioner&);
+
+	// A node of a partition at a lattice point on one of its shared faces
+	struct FaceNode
+	{
+		uint64_t point;         // x + (width + 1) * (y + (height + 1) * z)
+		uint64_t localId;
+		uint32_t partition;
+
+		bool operator<(const FaceNode& other) const { return point < other.point || (point == other.point && partition < other.partition); }
+	};
+
+	// Cuts the bins [first, end) on each axis among partitions [firstPartition, firstPartition + numPartitions)
+	void Split(const int first[3], const int end[3], const int firstPartition, const int numPartitions);
+
+	size_t BinIndex(const int bx, const int by, const int bz) const { return (static_cast<size_t>(bz) * mBinDims[1] + by) * mBinDims[0] + bx; }
+
+	const int mNumPartitions;
+	int mDims[3];
+	const float mSpacing;
+	const std::string mTempPrefix;
+
+	int mBinSize;               // voxels per bin along each axis
+	int mBinDims[3];
+	std::vector<uint32_t> mBins;    // foreground voxels per bin, x fastest
+	std::vector<int> mRuns;         // (begin, end) pairs of the row being counted
+
+	std::vector<int> mFirst;        // per partition, 3 axes, of voxels
+	std::vector<int> mEnd;
+
+	std::unique_ptr<ExternalSorter<FaceNode> > mFaceNodes;
+
+	std::vector<uint64_t> mFirstGlobalIds;
+	std::vector<uint64_t> mInterfaceNodeCounts;
+};
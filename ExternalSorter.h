@@ -0,0 +1,203 @@
+///  @file	ExternalSorter.h
+///  @brief	Implements class: ExternalSorter
+///
+///		Sorts more records than fit in memory. Records are buffered up to a
+///     fixed count; each full buffer is sorted and written to a run file,
+///     and Merge() does a k-way merge of the runs, reading each through a
+///     share of the same buffer. If every record fits in the buffer, no run
+///     is written and Merge() just sorts it.
+///
+///		At most kMaxFanIn runs are merged at a time, each an open file, and
+///     fewer if the buffer can't give each of them kMinReadRecords. With
+///     more runs than that, the oldest runs are merged into longer ones
+///     first. A small buffer and a large input then take several passes,
+///     rather than an open file per run and a read per record.
+///
+///		Record is a trivially copyable type with operator<. Records that
+///     compare equal come back in no particular order, so a record should
+///     carry a tie-break if the order matters.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <cstdio>
+
+template <typename Record>
+class ExternalSorter
+{
+public:
+	static const size_t kMaxFanIn = 64;
+	static const size_t kMinReadRecords = 4096;
+
+	// Holds up to maxRecords in memory. Runs are written to runPrefix followed by their number.
+	ExternalSorter(const std::string& runPrefix, const size_t maxRecords)
+	: mRunPrefix(runPrefix),
+	  mMaxRecords(std::max<size_t>(maxRecords, 2))
+	{
+	}
+
+	~ExternalSorter()
+	{
+		for (auto run = mRuns.begin(); run != mRuns.end(); ++run)
+			std::remove(run->c_str());
+	}
+
+	// Sizes the buffer for count records, or as many as it holds, so that it doesn't outgrow its memory as it fills
+	void Reserve(const size_t count)
+	{
+		mBuffer.reserve(std::min(count, mMaxRecords));
+	}
+
+	// Returns false if a run couldn't be written
+	bool Add(const Record& record)
+	{
+		mBuffer.push_back(record);
+		return mBuffer.size() < mMaxRecords || WriteRun();
+	}
+
+	// Hands every record to visit(const Record&), in ascending order. Call once, after the last Add().
+	// Returns false if a run couldn't be written or read back.
+	template <typename Visitor>
+	bool Merge(Visitor visit)
+	{
+		if (mRuns.empty())
+		{
+			std::sort(mBuffer.begin(), mBuffer.end());
+			for (auto record = mBuffer.begin(); record != mBuffer.end(); ++record)
+				visit(*record);
+			return true;
+		}
+		if (!mBuffer.empty() && !WriteRun())
+			return false;
+		std::vector<Record>().swap(mBuffer);
+
+		// Each run being merged, and the output of a merge into a longer run, gets a share of the buffer's worth
+		const size_t fanIn = std::min(kMaxFanIn, std::max<size_t>(mMaxRecords / kMinReadRecords, 2));
+		const size_t perRun = std::max<size_t>(mMaxRecords / (fanIn + 1), 1);
+
+		// The oldest fanIn runs become a new run, until one merge of the rest is left. Merged runs are
+		// removed, but their names stay in mRuns until then, so that a failure leaves no file behind.
+		size_t first = 0;
+		for (; mRuns.size() - first > fanIn; first += fanIn)
+		{
+			std::stringstream nameSS;
+			nameSS << mRunPrefix << mRuns.size();
+			mRuns.push_back(nameSS.str());
+			std::ofstream file(mRuns.back().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+			std::vector<Record> out;
+			out.reserve(perRun);
+			auto write = [&](const Record& record) {
+				out.push_back(record);
+				if (out.size() == perRun)
+				{
+					file.write(reinterpret_cast<const char*>(out.data()), out.size() * sizeof(Record));
+					out.clear();
+				}
+			};
+			if (!MergeRuns(first, fanIn, perRun, write))
+				return false;
+			file.write(reinterpret_cast<const char*>(out.data()), out.size() * sizeof(Record));
+			file.close();
+			if (!file)
+				return false;
+			for (size_t r = first; r < first + fanIn; ++r)
+				std::remove(mRuns[r].c_str());
+		}
+		mRuns.erase(mRuns.begin(), mRuns.begin() + first);
+
+		return MergeRuns(0, mRuns.size(), perRun, visit);
+	}
+
+protected:
+	ExternalSorter(const ExternalSorter&);            // not copyable
+	ExternalSorter& operator=(const ExternalSorter&);
+
+	struct RunReader
+	{
+		std::ifstream file;
+		std::vector<Record> records;
+		size_t next = 0;
+		size_t count = 0;
+
+		bool Next(Record& record)
+		{
+			if (next == count)
+			{
+				file.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(Record));
+				count = static_cast<size_t>(file.gcount()) / sizeof(Record);
+				next = 0;
+				if (count == 0)
+					return false;
+			}
+			record = records[next++];
+			return true;
+		}
+	};
+
+	// Merges runs [first, first + count), reading each perRun records at a time
+	template <typename Visitor>
+	bool MergeRuns(const size_t first, const size_t count, const size_t perRun, Visitor& visit)
+	{
+		std::vector<RunReader> readers(count);
+		typedef std::pair<Record, size_t> Head;     // a run's next record, and the run
+		auto later = [](const Head& a, const Head& b) { return b.first < a.first; };
+		std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
+		for (size_t r = 0; r < count; ++r)
+		{
+			readers[r].file.open(mRuns[first + r].c_str(), std::ios::in | std::ios::binary);
+			readers[r].records.resize(perRun);
+			if (!readers[r].file.good())
+				return false;
+			Record record;
+			if (readers[r].Next(record))
+				heads.push(Head(record, r));
+		}
+
+		while (!heads.empty())
+		{
+			const Head head = heads.top();
+			heads.pop();
+			visit(head.first);
+			Record record;
+			if (readers[head.second].Next(record))
+				heads.push(Head(record, head.second));
+		}
+
+		for (size_t r = 0; r < count; ++r)
+			if (readers[r].file.bad())
+				return false;
+		return true;
+	}
+
+	bool WriteRun()
+	{
+		std::sort(mBuffer.begin(), mBuffer.end());
+		std::stringstream nameSS;
+		nameSS << mRunPrefix << mRuns.size();
+		mRuns.push_back(nameSS.str());
+		std::ofstream file(mRuns.back().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(mBuffer.data()), mBuffer.size() * sizeof(Record));
+		mBuffer.clear();
+		return file.good();
+	}
+
+	const std::string mRunPrefix;
+	const size_t mMaxRecords;
+	std::vector<Record> mBuffer;
+	std::vector<std::string> mRuns;
+};
+
+template <typename Record> const size_t ExternalSorter<Record>::kMaxFanIn;
+template <typename Record> const size_t ExternalSorter<Record>::kMinReadRecords;
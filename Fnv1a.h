@@ -0,0 +1,32 @@
+///  @file	Fnv1a.h
+///  @brief	64-bit FNV-1a hashing
+///
+///		The hash behind the fingerprints of a run's inputs and options: the
+///     occupancy cache's fingerprint of the bitmaps and its file name
+///     (OccupancyCache.h), and the settings of a checkpoint (Checkpoint.h).
+///     Hashes are chained by passing the result of one call as the hash of
+///     the next, starting from kFnv1aSeed.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+const uint64_t kFnv1aSeed = 14695981039346656037ull;
+
+inline uint64_t Fnv1a(uint64_t hash, const void* data, const size_t size)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
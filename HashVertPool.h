@@ -0,0 +1,269 @@
+///  @file	HashVertPool.h
+///  @brief	Implements class: HashVertPool
+///
+///		Pools verts for re-use like VertPool (same keys, reference counts, ID
+///     re-use and position averaging) but with an open-addressing hash
+///     table instead of a std::map. Every entry lives in one flat array of
+///     slots, so adding a vert allocates nothing beyond occasionally growing
+///     that array, and AddVertRef() does a single probe sequence where
+///     VertPool does up to three map lookups.
+///
+///		Collisions are resolved by linear probing, and removal shifts the
+///     following entries back instead of leaving tombstones, so lookups
+///     stay short after many removals. AddVertRefs() adds a batch of verts,
+///     computing their keys and prefetching their slots ahead of the
+///     inserts.
+///
+///		Unlike VertPool::AddVertRef, AddVertRef() returns the ID by value.
+///     Slots move when the table grows, so a reference would not stay valid.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "VertPool.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define HASHVERTPOOL_PREFETCH(p) _mm_prefetch(reinterpret_cast<const char*>(p), _MM_HINT_T0)
+#elif defined(__GNUC__)
+#define HASHVERTPOOL_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define HASHVERTPOOL_PREFETCH(p)
+#endif
+
+template<class VertT>
+class HashVertPool
+{
+public:
+	HashVertPool(const KeyType dim, const Vec3& minVert, const Vec3& span, const size_t expectedVerts = 0);
+	VertIdType AddVertRef(const VertT& v);
+	void AddVertRefs(const VertT* verts, const size_t count, VertIdType* ids);
+	const std::vector<VertT>& GetPooledVerts() const { return mVerts; }
+	void RemoveVertRef(const VertIdType& vId);
+	void RemoveVertRef(const Vec3& pos);
+
+protected:
+	struct Slot
+	{
+		KeyType key;
+		VertIdType id;
+		RefCountType refCount;
+	};
+
+	static const KeyType kEmptyKey = ~static_cast<KeyType>(0); // keys are below dim^3, so never this
+
+	KeyType GetKey(const Vec3& p) const { return GetVertPoolKey(p.x, p.y, p.z, mDim, mMin, mSpan); }
+	static size_t Hash(KeyType key);
+
+	VertIdType AddVertRef(const VertT& v, const KeyType key);
+	size_t FindSlot(const KeyType key) const; // the slot holding key, or the empty slot it would go in
+	void EraseSlot(size_t slot);
+	void Grow();
+
+	std::vector<VertT> mVerts;
+
+	std::vector<Slot> mSlots;       // size is a power of two
+	size_t mMask;                   // mSlots.size() - 1
+	size_t mCount;                  // occupied slots
+	std::vector<VertIdType> mAvailable;
+
+	const KeyType mDim;
+	const Vec3 mMin;
+	const Vec3 mSpan;
+};
+
+
+template<class VertT>
+const KeyType HashVertPool<VertT>::kEmptyKey;
+
+template<class VertT>
+HashVertPool<VertT>::HashVertPool(const KeyType dim, const Vec3& minVert, const Vec3& span, const size_t expectedVerts)
+: mMask(0),
+  mCount(0),
+  mDim(dim),
+  mMin(minVert),
+  mSpan(span)
+{
+	// Room for expectedVerts at the maximum load factor of 3/4
+	size_t capacity = 16;
+	while (capacity * 3 < expectedVerts * 4)
+		capacity *= 2;
+
+	Slot empty = { kEmptyKey, 0, 0 };
+	mSlots.assign(capacity, empty);
+	mMask = capacity - 1;
+}
+
+template<class VertT>
+size_t HashVertPool<VertT>::Hash(KeyType key)
+{
+	// Keys of neighbouring cells differ in their low bits only, so mix them before masking
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdull;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ull;
+	key ^= key >> 33;
+	return static_cast<size_t>(key);
+}
+
+template<class VertT>
+size_t HashVertPool<VertT>::FindSlot(const KeyType key) const
+{
+	size_t slot = Hash(key) & mMask;
+	while (mSlots[slot].key != key && mSlots[slot].key != kEmptyKey)
+		slot = (slot + 1) & mMask;
+	return slot;
+}
+
+template<class VertT>
+VertIdType HashVertPool<VertT>::AddVertRef(const VertT& v)
+{
+	return AddVertRef(v, GetKey(v.pos));
+}
+
+template<class VertT>
+VertIdType HashVertPool<VertT>::AddVertRef(const VertT& v, const KeyType key)
+{
+	size_t slot = FindSlot(key);
+
+	// If we don't have a nearby vert already in the pool
+	if (mSlots[slot].key == kEmptyKey)
+	{
+		if ((mCount + 1) * 4 > mSlots.size() * 3)
+		{
+			Grow();
+			slot = FindSlot(key);
+		}
+
+		VertIdType newVertId;
+		if (mAvailable.empty())
+		{
+			newVertId = mVerts.size();
+			mVerts.push_back(v);
+		}
+		else
+		{
+			// Re-use an existing location in the vert-pool
+			newVertId = mAvailable.back();
+			mAvailable.pop_back();
+			mVerts[newVertId] = v;
+		}
+
+		Slot& s = mSlots[slot];
+		s.key = key;
+		s.id = newVertId;
+		s.refCount = 1;
+		++mCount;
+	}
+	else
+		++mSlots[slot].refCount;
+
+	const VertIdType vertIndex = mSlots[slot].id;
+
+	// Average the existing position with the newly referenced position
+	VertT& pooled = mVerts[vertIndex];
+	pooled.pos = (pooled.pos + v.pos) * 0.5f;
+
+	return vertIndex;
+}
+
+template<class VertT>
+void HashVertPool<VertT>::AddVertRefs(const VertT* verts, const size_t count, VertIdType* ids)
+{
+	const size_t kBatch = 16;
+	KeyType keys[kBatch];
+	for (size_t first = 0; first < count; first += kBatch)
+	{
+		const size_t n = (count - first < kBatch) ? (count - first) : kBatch;
+
+		// Compute the batch's keys and start loading their slots before any of them is needed
+		for (size_t i = 0; i < n; ++i)
+		{
+			keys[i] = GetKey(verts[first + i].pos);
+			HASHVERTPOOL_PREFETCH(&mSlots[Hash(keys[i]) & mMask]);
+		}
+
+		for (size_t i = 0; i < n; ++i)
+			ids[first + i] = AddVertRef(verts[first + i], keys[i]);
+	}
+}
+
+template<class VertT>
+void HashVertPool<VertT>::RemoveVertRef(const VertIdType& vId)
+{
+	RemoveVertRef(mVerts[vId].pos);
+}
+
+template<class VertT>
+void HashVertPool<VertT>::RemoveVertRef(const Vec3& pos)
+{
+	const size_t slot = FindSlot(GetKey(pos));
+	if (mSlots[slot].key == kEmptyKey)
+	{
+		LOG_WARN("Key not found!");
+		return;
+	}
+
+	RefCountType& refCount = mSlots[slot].refCount;
+	if (refCount != 0) // don't wrap past zero
+		--refCount;
+	else
+		LOG_WARN("Ignoring attempt to decrement ref count below zero");
+
+	if (refCount == 0)
+	{
+		// Store the ID of the vert for re-use, and delete the vert from the table
+		mAvailable.push_back(mSlots[slot].id);
+		EraseSlot(slot);
+	}
+}
+
+template<class VertT>
+void HashVertPool<VertT>::EraseSlot(size_t slot)
+{
+	// Move later entries of the probe sequence back into the hole, unless that would put an
+	// entry before its home slot. This keeps every entry reachable without tombstones.
+	size_t next = slot;
+	for (;;)
+	{
+		next = (next + 1) & mMask;
+		if (mSlots[next].key == kEmptyKey)
+			break;
+
+		const size_t home = Hash(mSlots[next].key) & mMask;
+		const bool homeInRange = (slot <= next) ? (slot < home && home <= next)
+												: (slot < home || home <= next);
+		if (!homeInRange)
+		{
+			mSlots[slot] = mSlots[next];
+			slot = next;
+		}
+	}
+
+	mSlots[slot].key = kEmptyKey;
+	--mCount;
+}
+
+template<class VertT>
+void HashVertPool<VertT>::Grow()
+{
+	std::vector<Slot> old;
+	old.swap(mSlots);
+
+	Slot empty = { kEmptyKey, 0, 0 };
+	mSlots.assign(old.size() * 2, empty);
+	mMask = mSlots.size() - 1;
+
+	for (auto s = old.begin(); s != old.end(); ++s)
+	{
+		if (s->key != kEmptyKey)
+			mSlots[FindSlot(s->key)] = *s;
+	}
+}
@@ -0,0 +1,261 @@
+///  @file	LatticeNodePool.cpp
+///  @brief	Implements class: LatticeNodePool
+///
+///		Pools the nodes of a cube-lattice that is built one slice at a time.
+///     See LatticeNodePool.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "LatticeNodePool.h"
+
+#include <algorithm>
+#include <climits>
+
+LatticeNodePool::LatticeNodePool(const int x0, const int y0, const int width, const int height)
+: mFirstPendingId(0),
+  mX0(x0),
+  mY0(y0),
+  mRowLen(width + 1),
+  mRows(height + 1),
+  mWide(3 * static_cast<uint64_t>(mRowLen) * mRows >= NoNode<uint32_t>()),
+  mZ(-2),
+  mSpacing(1.0f)
+{
+	for (int dz = 0; dz < 2; ++dz)
+	{
+		if (mWide)
+			mWidePlanes[dz].assign(GetPlaneSize(), NoNode<uint64_t>());
+		else
+			mPlanes[dz].assign(GetPlaneSize(), NoNode<uint32_t>());
+	}
+	mBases[0] = mBases[1] = 0;
+	for (int dz = 0; dz < 2; ++dz)
+	{
+		mDirty[dz][0] = mDirty[dz][1] = INT_MAX;
+		mDirty[dz][2] = mDirty[dz][3] = -1;
+	}
+}
+
+template<class OffsetT>
+void LatticeNodePool::ClearPlane(const int dz)
+{
+	int* dirty = mDirty[dz];
+	for (int row = dirty[1]; row <= dirty[3]; ++row)
+	{
+		OffsetT* ids = &GetPlanes<OffsetT>()[dz][static_cast<size_t>(row) * mRowLen];
+		std::fill(ids + dirty[0], ids + dirty[2] + 1, NoNode<OffsetT>());
+	}
+	dirty[0] = dirty[1] = INT_MAX;
+	dirty[2] = dirty[3] = -1;
+}
+
+void LatticeNodePool::BeginSlice(const int z)
+{
+	if (z == mZ)
+		return;
+
+	if (z == mZ + 1)
+	{
+		// The upper plane of the previous slice is the lower plane of this one
+		if (mWide)
+			ClearPlane<uint64_t>(0);
+		else
+			ClearPlane<uint32_t>(0);
+		mPlanes[0].swap(mPlanes[1]);
+		mWidePlanes[0].swap(mWidePlanes[1]);
+		std::swap(mDirty[0], mDirty[1]);
+		mBases[0] = mBases[1];
+		mBases[1] = GetNodeCount();
+	}
+	else
+	{
+		// First slice, or slices were skipped: nothing is shared
+		for (int dz = 0; dz < 2; ++dz)
+		{
+			if (mWide)
+				ClearPlane<uint64_t>(dz);
+			else
+				ClearPlane<uint32_t>(dz);
+		}
+		mBases[0] = mBases[1] = GetNodeCount();
+	}
+	mZ = z;
+}
+
+void LatticeNodePool::AppendRunElements(const int xBegin, const int xEnd, const int y, std::vector<VertIdType>& elements)
+{
+	if (xBegin >= xEnd)
+		return;
+	if (mWide)
+		AppendRun<uint64_t>(xBegin, xEnd, y, elements);
+	else
+		AppendRun<uint32_t>(xBegin, xEnd, y, elements);
+}
+
+template<class OffsetT>
+void LatticeNodePool::AppendRun(const int xBegin, const int xEnd, const int y, std::vector<VertIdType>& elements)
+{
+	// The four node rows of the run, (y, y+1) on planes z and z+1, from node column xBegin
+	const size_t first = static_cast<size_t>(y - mY0) * mRowLen + (xBegin - mX0);
+	std::vector<OffsetT>* const planes = GetPlanes<OffsetT>();
+	OffsetT* const lo0 = &planes[0][first];
+	OffsetT* const hi0 = lo0 + mRowLen;
+	OffsetT* const lo1 = &planes[1][first];
+	OffsetT* const hi1 = lo1 + mRowLen;
+	const VertIdType base0 = mBases[0];
+	const VertIdType base1 = mBases[1];
+	MarkDirty(0, xBegin - mX0, y - mY0, xEnd - mX0, y + 1 - mY0);
+	MarkDirty(1, xBegin - mX0, y - mY0, xEnd - mX0, y + 1 - mY0);
+
+	// The first voxel touches both of its node columns, in AddNodeRef order
+	TouchNode(lo0[0], xBegin,     y,     0);
+	TouchNode(lo0[1], xBegin + 1, y,     0);
+	TouchNode(hi0[0], xBegin,     y + 1, 0);
+	TouchNode(hi0[1], xBegin + 1, y + 1, 0);
+	TouchNode(lo1[0], xBegin,     y,     1);
+	TouchNode(lo1[1], xBegin + 1, y,     1);
+	TouchNode(hi1[0], xBegin,     y + 1, 1);
+	TouchNode(hi1[1], xBegin + 1, y + 1, 1);
+
+	const int count = xEnd - xBegin;
+	const size_t offset = elements.size();
+	elements.resize(offset + 8 * static_cast<size_t>(count));
+	VertIdType* out = &elements[offset];
+	for (int i = 0; i < count; ++i, out += 8)
+	{
+		// Later voxels share their x column with the previous voxel, so only the x+1 column can be new
+		if (i > 0)
+		{
+			const int x = xBegin + i;
+			TouchNode(lo0[i + 1], x + 1, y,     0);
+			TouchNode(hi0[i + 1], x + 1, y + 1, 0);
+			TouchNode(lo1[i + 1], x + 1, y,     1);
+			TouchNode(hi1[i + 1], x + 1, y + 1, 1);
+		}
+
+		out[0] = base0 + lo0[i];
+		out[1] = base0 + lo0[i + 1];
+		out[2] = base0 + hi0[i + 1];
+		out[3] = base0 + hi0[i];
+		out[4] = base1 + lo1[i];
+		out[5] = base1 + lo1[i + 1];
+		out[6] = base1 + hi1[i + 1];
+		out[7] = base1 + hi1[i];
+	}
+}
+
+void LatticeNodePool::ClearPendingNodes()
+{
+	mFirstPendingId += mNodes.size();
+	mNodes.clear();
+}
+
+void LatticeNodePool::WriteState(std::ostream& os) const
+{
+	const uint64_t firstPendingId = mFirstPendingId;
+	const uint64_t bases[2] = { mBases[0], mBases[1] };
+	const int32_t z = mZ;
+	const uint32_t entryBytes = static_cast<uint32_t>(GetPlaneEntryBytes());
+	os.write(reinterpret_cast<const char*>(&firstPendingId), sizeof(firstPendingId));
+	os.write(reinterpret_cast<const char*>(bases), sizeof(bases));
+	os.write(reinterpret_cast<const char*>(&z), sizeof(z));
+	os.write(reinterpret_cast<const char*>(&entryBytes), sizeof(entryBytes));
+
+	// Only the touched rectangle of each plane holds nodes. It is saved in lattice coordinates.
+	for (int dz = 0; dz < 2; ++dz)
+	{
+		const int* dirty = mDirty[dz];
+		const bool empty = dirty[0] > dirty[2];
+		const int32_t rect[4] = { empty ? 0 : dirty[0] + mX0, empty ? 0 : dirty[1] + mY0,
+								  empty ? -1 : dirty[2] + mX0, empty ? -1 : dirty[3] + mY0 };
+		os.write(reinterpret_cast<const char*>(rect), sizeof(rect));
+		for (int row = dirty[1]; row <= dirty[3]; ++row)
+		{
+			const size_t first = static_cast<size_t>(row) * mRowLen + dirty[0];
+			const char* ids = mWide ? reinterpret_cast<const char*>(&mWidePlanes[dz][first])
+									: reinterpret_cast<const char*>(&mPlanes[dz][first]);
+			os.write(ids, static_cast<size_t>(dirty[2] - dirty[0] + 1) * entryBytes);
+		}
+	}
+}
+
+template<class OffsetT>
+bool LatticeNodePool::ReadPlaneRows(std::istream& is, const int dz, const int col0, const int row0,
+									const int col1, const int row1, const size_t entryBytes)
+{
+	// The state may come from a pool with offsets of the other width
+	const size_t count = static_cast<size_t>(col1 - col0 + 1);
+	std::vector<uint32_t> narrow(entryBytes == sizeof(uint32_t) ? count : 0);
+	std::vector<uint64_t> wide(entryBytes == sizeof(uint64_t) ? count : 0);
+	for (int row = row0; row <= row1; ++row)
+	{
+		if (!narrow.empty())
+			is.read(reinterpret_cast<char*>(narrow.data()), count * sizeof(uint32_t));
+		else
+			is.read(reinterpret_cast<char*>(wide.data()), count * sizeof(uint64_t));
+		if (!is)
+			return false;
+
+		OffsetT* ids = &GetPlanes<OffsetT>()[dz][static_cast<size_t>(row) * mRowLen + col0];
+		for (size_t i = 0; i < count; ++i)
+		{
+			const bool none = narrow.empty() ? (wide[i] == NoNode<uint64_t>()) : (narrow[i] == NoNode<uint32_t>());
+			const uint64_t id = narrow.empty() ? wide[i] : narrow[i];
+			if (!none && id >= NoNode<OffsetT>())
+				return false;
+			ids[i] = none ? NoNode<OffsetT>() : static_cast<OffsetT>(id);
+		}
+	}
+	return true;
+}
+
+bool LatticeNodePool::ReadState(std::istream& is)
+{
+	uint64_t firstPendingId;
+	uint64_t bases[2];
+	int32_t z;
+	uint32_t entryBytes;
+	is.read(reinterpret_cast<char*>(&firstPendingId), sizeof(firstPendingId));
+	is.read(reinterpret_cast<char*>(bases), sizeof(bases));
+	is.read(reinterpret_cast<char*>(&z), sizeof(z));
+	is.read(reinterpret_cast<char*>(&entryBytes), sizeof(entryBytes));
+	if (!is || (entryBytes != sizeof(uint32_t) && entryBytes != sizeof(uint64_t)))
+		return false;
+
+	mNodes.clear();
+	mFirstPendingId = firstPendingId;
+	mBases[0] = bases[0];
+	mBases[1] = bases[1];
+	mZ = z;
+
+	for (int dz = 0; dz < 2; ++dz)
+	{
+		std::fill(mPlanes[dz].begin(), mPlanes[dz].end(), NoNode<uint32_t>());
+		std::fill(mWidePlanes[dz].begin(), mWidePlanes[dz].end(), NoNode<uint64_t>());
+		mDirty[dz][0] = mDirty[dz][1] = INT_MAX;
+		mDirty[dz][2] = mDirty[dz][3] = -1;
+
+		int32_t rect[4];
+		is.read(reinterpret_cast<char*>(rect), sizeof(rect));
+		if (!is)
+			return false;
+		if (rect[0] > rect[2])
+			continue;
+
+		const int col0 = rect[0] - mX0, row0 = rect[1] - mY0, col1 = rect[2] - mX0, row1 = rect[3] - mY0;
+		if (col0 < 0 || row0 < 0 || row0 > row1 || col1 >= mRowLen || row1 >= mRows)
+			return false;
+		const bool read = mWide ? ReadPlaneRows<uint64_t>(is, dz, col0, row0, col1, row1, entryBytes)
+								: ReadPlaneRows<uint32_t>(is, dz, col0, row0, col1, row1, entryBytes);
+		if (!read)
+			return false;
+		MarkDirty(dz, col0, row0, col1, row1);
+	}
+	return static_cast<bool>(is);
+}
+
+// EOF
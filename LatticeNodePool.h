@@ -0,0 +1,157 @@
+///  @file	LatticeNodePool.h
+///  @brief	Implements class: LatticeNodePool
+///
+///		Pools the nodes of a cube-lattice that is built one slice at a time.
+///     Nodes are keyed by their integer lattice coordinate (x, y, z) rather
+///     than by a quantized float position, so a lookup is a direct array index.
+///
+///		Only the two node planes touched by the current slice are kept (plane z
+///     and plane z+1). BeginSlice() rolls the upper plane down when the next
+///     slice starts, so memory is bounded by two planes of node IDs plus the
+///     positions of the nodes that haven't been written yet.
+///
+///		A node's position never changes once it has an ID, so nodes can be
+///     written as soon as they are created: GetPendingNodes() holds the
+///     nodes created since the last ClearPendingNodes(), in ID order.
+///
+///		A pool only covers the voxels (x0, y0) to (x0 + width - 1,
+///     y0 + height - 1), so a group whose box covers a small part of the
+///     image keeps correspondingly small planes.
+///
+///		Node IDs are 64-bit, but the planes store them as offsets from the
+///     node count when the plane was started. Every node in a plane is
+///     created while that plane is one of the two live planes, so an offset
+///     stays below three planes' worth of nodes. Offsets are 32-bit, 4 bytes
+///     per node, unless three planes can hold 2^32 - 1 nodes (pools wider
+///     than about 37000 x 37000), when they are 64-bit.
+///
+///		Each plane tracks the rectangle of nodes that were touched since it was
+///     last cleared, so BeginSlice() only resets that rectangle rather than
+///     the whole plane. Slices that are mostly background, or whose
+///     foreground is far smaller than the group's box, start in time
+///     proportional to their foreground rather than the box.
+///
+///		AppendRunElements() meshes a whole run of foreground voxels along x.
+///     It looks up the four node rows the run touches once, then walks them
+///     in step, so a voxel in the middle of a run costs four plane reads (the
+///     nodes on its x+1 side) and no per-node index arithmetic.
+///
+///		Node IDs are handed out in first-touch order, and keys are exact, so
+///     no two lattice points share a node. VertPool<SIMPLE_VERTEX> keys a
+///     node by quantizing its position into 1.2 * width cells over the span
+///     (width + 2, height + 2, depth + 2), and so merges distinct lattice
+///     points: on the x=0, y=0 and z=0 planes, where negative offsets wrap;
+///     along y or z when the stack is more than about 1.2 times as tall or
+///     deep as it is wide; and anywhere once (1.2 * width)^3 passes 2^32.
+///     The output differs from VertPool's wherever it merged nodes, and every
+///     ID after the first merged node differs as well. Where VertPool merged
+///     none, the nodes and indices files are the same.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <cstdint>
+#include "VertPool.h" // Vec3, VertIdType
+
+class LatticeNodePool
+{
+public:
+	LatticeNodePool(const int x0, const int y0, const int width, const int height);
+
+	// Nodes are placed at spacing * (x, y, z), e.g. k for a lattice coarsened k times (1 by default)
+	void SetSpacing(const float spacing) { mSpacing = spacing; }
+
+	void BeginSlice(const int z);
+	inline VertIdType AddNodeRef(const int x, const int y, const int dz);
+
+	// Appends the elements of voxels [xBegin, xEnd) of row y, 8 node IDs each in output order,
+	// with the same node IDs that calling AddNodeRef for each voxel in turn would hand out
+	void AppendRunElements(const int xBegin, const int xEnd, const int y, std::vector<VertIdType>& elements);
+
+	uint64_t GetNodeCount() const { return mFirstPendingId + mNodes.size(); }
+	size_t GetPlaneSize() const { return static_cast<size_t>(mRowLen) * mRows; }
+	size_t GetPlaneEntryBytes() const { return mWide ? sizeof(uint64_t) : sizeof(uint32_t); }
+	VertIdType GetFirstPendingId() const { return mFirstPendingId; }
+	const std::vector<Vec3>& GetPendingNodes() const { return mNodes; }
+	void ClearPendingNodes();
+
+	// The pool's state between slices (once pending nodes are cleared), for checkpoints. ReadState()
+	// accepts the state of a pool of another extent, as long as every node it holds is inside this one.
+	void WriteState(std::ostream& os) const;
+	bool ReadState(std::istream& is);
+
+protected:
+	// The planes of either width, and the entry of a node that hasn't been touched
+	template<class OffsetT> std::vector<OffsetT>* GetPlanes();
+	template<class OffsetT> static OffsetT NoNode() { return ~static_cast<OffsetT>(0); }
+
+	template<class OffsetT> inline VertIdType AddNodeRef(const int x, const int y, const int dz);
+	template<class OffsetT> void AppendRun(const int xBegin, const int xEnd, const int y, std::vector<VertIdType>& elements);
+	template<class OffsetT> inline void TouchNode(OffsetT& id, const int x, const int y, const int dz);
+	inline void MarkDirty(const int dz, const int col0, const int row0, const int col1, const int row1);
+	template<class OffsetT> void ClearPlane(const int dz);
+	template<class OffsetT> bool ReadPlaneRows(std::istream& is, const int dz, const int col0, const int row0,
+											   const int col1, const int row1, const size_t entryBytes);
+
+	std::vector<Vec3> mNodes;           // nodes mFirstPendingId onwards
+	VertIdType mFirstPendingId;
+
+	std::vector<uint32_t> mPlanes[2];       // node IDs for plane z (0) and plane z+1 (1), less mBases
+	std::vector<uint64_t> mWidePlanes[2];   // the same, instead, if mWide
+	VertIdType mBases[2];                   // node count when each plane was started
+	int mDirty[2][4];                       // per plane: first column, first row, last column, last row touched (inclusive)
+
+	const int mX0;      // lattice coordinate of the first node of a row
+	const int mY0;      // lattice coordinate of the first row
+	const int mRowLen;  // nodes per row (width + 1)
+	const int mRows;    // rows per plane (height + 1)
+	const bool mWide;   // planes hold 64-bit offsets
+	int mZ;             // slice index of plane 0
+	float mSpacing;     // node position per lattice coordinate
+};
+
+template<> inline std::vector<uint32_t>* LatticeNodePool::GetPlanes<uint32_t>() { return mPlanes; }
+template<> inline std::vector<uint64_t>* LatticeNodePool::GetPlanes<uint64_t>() { return mWidePlanes; }
+
+template<class OffsetT>
+void LatticeNodePool::TouchNode(OffsetT& id, const int x, const int y, const int dz)
+{
+	if (id == NoNode<OffsetT>())
+	{
+		id = static_cast<OffsetT>(GetNodeCount() - mBases[dz]);
+		mNodes.push_back(Vec3(mSpacing * static_cast<float>(x),
+							  mSpacing * static_cast<float>(y),
+							  mSpacing * static_cast<float>(mZ + dz)));
+	}
+}
+
+void LatticeNodePool::MarkDirty(const int dz, const int col0, const int row0, const int col1, const int row1)
+{
+	int* dirty = mDirty[dz];
+	if (col0 < dirty[0]) dirty[0] = col0;
+	if (row0 < dirty[1]) dirty[1] = row0;
+	if (col1 > dirty[2]) dirty[2] = col1;
+	if (row1 > dirty[3]) dirty[3] = row1;
+}
+
+template<class OffsetT>
+VertIdType LatticeNodePool::AddNodeRef(const int x, const int y, const int dz)
+{
+	MarkDirty(dz, x - mX0, y - mY0, x - mX0, y - mY0);
+	OffsetT& id = GetPlanes<OffsetT>()[dz][static_cast<size_t>(y - mY0) * mRowLen + (x - mX0)];
+	TouchNode(id, x, y, dz);
+	return mBases[dz] + id;
+}
+
+VertIdType LatticeNodePool::AddNodeRef(const int x, const int y, const int dz)
+{
+	return mWide ? AddNodeRef<uint64_t>(x, y, dz) : AddNodeRef<uint32_t>(x, y, dz);
+}
@@ -0,0 +1,147 @@
+///  @file	MappedBitmap.cpp
+///  @brief	Implements class: MappedBitmap
+///
+///		A read-only, memory mapped view of an uncompressed BMP file. See
+///     MappedBitmap.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "MappedBitmap.h"
+
+#include <climits>
+
+namespace
+{
+	// BMP headers are little-endian and the fields are not aligned
+	ebmpWORD ReadWORD(const ebmpBYTE* p)
+	{
+		return static_cast<ebmpWORD>(p[0] | (p[1] << 8));
+	}
+
+	ebmpDWORD ReadDWORD(const ebmpBYTE* p)
+	{
+		return static_cast<ebmpDWORD>(p[0]) | (static_cast<ebmpDWORD>(p[1]) << 8) |
+			   (static_cast<ebmpDWORD>(p[2]) << 16) | (static_cast<ebmpDWORD>(p[3]) << 24);
+	}
+
+	const size_t kFileHeaderSize = 14;
+	const size_t kMinInfoHeaderSize = 40;
+}
+
+MappedBitmap::MappedBitmap()
+: mPixels(NULL),
+  mRowStride(0),
+  mWidth(0),
+  mHeight(0),
+  mBitDepth(0),
+  mTopDown(false)
+{
+}
+
+bool MappedBitmap::Open(const char* filename)
+{
+	Close();
+	if (!mFile.Open(filename))
+		return false;
+
+	if (!ParseHeaders())
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedBitmap::Close()
+{
+	mFile.Close();
+	mPixels = NULL;
+	mWidth = mHeight = mBitDepth = 0;
+}
+
+bool MappedBitmap::ParseHeaders()
+{
+	const ebmpBYTE* const data = mFile.GetData();
+	const size_t size = mFile.GetSize();
+
+	if (size < kFileHeaderSize + kMinInfoHeaderSize)
+		return false;
+
+	BMFH bmfh;
+	bmfh.bfType      = ReadWORD(data);
+	bmfh.bfSize      = ReadDWORD(data + 2);
+	bmfh.bfReserved1 = ReadWORD(data + 6);
+	bmfh.bfReserved2 = ReadWORD(data + 8);
+	bmfh.bfOffBits   = ReadDWORD(data + 10);
+
+	const ebmpBYTE* info = data + kFileHeaderSize;
+	BMIH bmih;
+	bmih.biSize          = ReadDWORD(info);
+	bmih.biWidth         = ReadDWORD(info + 4);
+	bmih.biHeight        = ReadDWORD(info + 8);
+	bmih.biPlanes        = ReadWORD(info + 12);
+	bmih.biBitCount      = ReadWORD(info + 14);
+	bmih.biCompression   = ReadDWORD(info + 16);
+	bmih.biSizeImage     = ReadDWORD(info + 20);
+	bmih.biXPelsPerMeter = ReadDWORD(info + 24);
+	bmih.biYPelsPerMeter = ReadDWORD(info + 28);
+	bmih.biClrUsed       = ReadDWORD(info + 32);
+	bmih.biClrImportant  = ReadDWORD(info + 36);
+
+	if (bmfh.bfType != 19778) // "BM"
+		return false;
+	if (bmih.biSize < kMinInfoHeaderSize || bmih.biCompression != 0)
+		return false;
+	if (bmih.biBitCount != 8 && bmih.biBitCount != 24 && bmih.biBitCount != 32)
+		return false;
+
+	const int width = static_cast<int>(bmih.biWidth);
+	const int height = static_cast<int>(bmih.biHeight);
+	if (width <= 0 || height == 0 || height == INT_MIN)
+		return false;
+
+	mWidth = width;
+	mHeight = height < 0 ? -height : height;
+	mTopDown = height < 0;
+	mBitDepth = bmih.biBitCount;
+	mRowStride = ((static_cast<size_t>(mWidth) * mBitDepth + 31) / 32) * 4;
+
+	const size_t paletteOffset = kFileHeaderSize + bmih.biSize;
+	if (bmfh.bfOffBits < paletteOffset ||
+		bmfh.bfOffBits > size ||
+		size - bmfh.bfOffBits < mRowStride * mHeight)
+		return false;
+
+	if (mBitDepth == 8)
+	{
+		// Colours missing from an underspecified table are white, as in BMP::ReadFromFile
+		size_t numColors = (bmfh.bfOffBits - paletteOffset) / 4;
+		if (numColors > 256)
+			numColors = 256;
+		for (size_t n = 0; n < 256; ++n)
+		{
+			if (n < numColors)
+			{
+				const ebmpBYTE* c = data + paletteOffset + 4 * n;
+				mColors[n].Blue  = c[0];
+				mColors[n].Green = c[1];
+				mColors[n].Red   = c[2];
+				mColors[n].Alpha = c[3];
+			}
+			else
+			{
+				mColors[n].Blue = mColors[n].Green = mColors[n].Red = 255;
+				mColors[n].Alpha = 0;
+			}
+		}
+	}
+
+	mPixels = data + bmfh.bfOffBits;
+	return true;
+}
+
+// EOF
@@ -0,0 +1,64 @@
+///  @file	MappedBitmap.h
+///  @brief	Implements class: MappedBitmap
+///
+///		A read-only view of an uncompressed 8, 24 or 32-bit BMP file through a
+///     memory mapping. The file and info headers (BMFH, BMIH) are validated
+///     when the file is opened, and GetRow() then returns a pointer straight
+///     into the mapped pixel data, so reading a slice costs no heap
+///     allocation and no copy.
+///
+///		Rows are numbered top-down like BMP::operator() (row 0 is the top of
+///     the image) for both bottom-up and top-down files. Anything else (1, 4
+///     or 16-bit, RLE, bit fields, truncated files) fails Open(), and the
+///     caller should fall back to BMP::ReadFromFile.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <cstddef>
+#include "easybmp/EasyBMP.h"
+#include "MappedFile.h"
+
+class MappedBitmap
+{
+public:
+	MappedBitmap();
+
+	bool Open(const char* filename);
+	void Close();
+	bool IsOpen() const { return mPixels != NULL; }
+
+	int GetWidth() const { return mWidth; }
+	int GetHeight() const { return mHeight; }
+	int GetBitDepth() const { return mBitDepth; }
+
+	// 256 entries for 8-bit files (padded with white, as BMP::ReadFromFile does), NULL otherwise
+	const RGBApixel* GetColorTable() const { return mBitDepth == 8 ? mColors : NULL; }
+
+	inline const ebmpBYTE* GetRow(const int y) const
+	{
+		const int fileRow = mTopDown ? y : (mHeight - 1 - y);
+		return mPixels + static_cast<ptrdiff_t>(fileRow) * mRowStride;
+	}
+
+protected:
+	MappedBitmap(const MappedBitmap&);            // not copyable
+	MappedBitmap& operator=(const MappedBitmap&);
+
+	bool ParseHeaders();
+
+	MappedFile mFile;
+	const ebmpBYTE* mPixels;    // first byte of the pixel array
+	size_t mRowStride;
+
+	int mWidth;
+	int mHeight;
+	int mBitDepth;
+	bool mTopDown;
+	RGBApixel mColors[256];
+};
@@ -0,0 +1,122 @@
+///  @file	MappedFile.cpp
+///  @brief	Implements class: MappedFile
+///
+///		A read-only memory mapping of a whole file. See MappedFile.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+: mData(NULL),
+  mSize(0)
+#ifdef _WIN32
+  , mFileHandle(NULL),
+  mMappingHandle(NULL)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const char* filename)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+							  FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == NULL)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	mFileHandle = file;
+	mMappingHandle = mapping;
+	mData = static_cast<const unsigned char*>(view);
+	mSize = static_cast<size_t>(size.QuadPart);
+#else
+	const int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	void* view = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // the mapping keeps its own reference to the file
+	if (view == MAP_FAILED)
+		return false;
+
+#ifdef MADV_SEQUENTIAL
+	madvise(view, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+#endif
+
+	mData = static_cast<const unsigned char*>(view);
+	mSize = static_cast<size_t>(st.st_size);
+#endif
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (mData)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(mData);
+		CloseHandle(static_cast<HANDLE>(mMappingHandle));
+		CloseHandle(static_cast<HANDLE>(mFileHandle));
+		mMappingHandle = NULL;
+		mFileHandle = NULL;
+#else
+		munmap(const_cast<unsigned char*>(mData), mSize);
+#endif
+	}
+
+	mData = NULL;
+	mSize = 0;
+}
+
+// EOF
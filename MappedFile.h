@@ -0,0 +1,43 @@
+///  @file	MappedFile.h
+///  @brief	Implements class: MappedFile
+///
+///		A read-only memory mapping of a whole file (mmap on POSIX, a file
+///     mapping object on Windows). The OS is told the file will be read
+///     sequentially.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <cstddef>
+
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	// Fails for files that are missing, empty or can't be mapped
+	bool Open(const char* filename);
+	void Close();
+	bool IsOpen() const { return mData != NULL; }
+
+	const unsigned char* GetData() const { return mData; }
+	size_t GetSize() const { return mSize; }
+
+protected:
+	MappedFile(const MappedFile&);            // not copyable
+	MappedFile& operator=(const MappedFile&);
+
+	const unsigned char* mData;
+	size_t mSize;
+
+#ifdef _WIN32
+	void* mFileHandle;
+	void* mMappingHandle;
+#endif
+};
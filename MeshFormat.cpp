@@ -0,0 +1,269 @@
+///  @file	MeshFormat.cpp
+///  @brief	Implements classes: MeshFormat, AsciiMeshFormat, BinaryMeshFormat
+///
+///		Formats the nodes and elements (indices) of the cube-lattice for output.
+///     See MeshFormat.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "MeshFormat.h"
+#include "TextFormat.h"
+
+#include <cstring>
+
+namespace
+{
+	const char kSep[] = ",\t";
+	const size_t kSepLength = sizeof(kSep) - 1;
+
+	// "\t<id>" then a ",\t<id>" per node, then "\n"
+	size_t MaxElementChars(const uint32_t nodesPerElement)
+	{
+		return 1 + kMaxUIntChars + nodesPerElement * (kSepLength + kMaxUIntChars) + 1;
+	}
+
+	// "\t<id>" then 3 of ",\t<coordinate>", then "\n"
+	const size_t kMaxNodeChars = 1 + kMaxUIntChars + 3 * (kSepLength + kMaxFloatChars) + 1;
+
+	// "\t<id>" then up to 4 of ",\t<id>", then "\n"
+	const size_t kMaxConstraintChars = 1 + kMaxUIntChars + (kConstraintValues - 1) * (kSepLength + kMaxUIntChars) + 1;
+
+	// "\t<id>" then ",\t<global id>" and ",\t<partition>", then "\n"
+	const size_t kMaxInterfaceChars = 1 + kMaxUIntChars + (kInterfaceValues - 1) * (kSepLength + kMaxUIntChars) + 1;
+}
+
+void AsciiMeshFormat::AppendElements(std::string& block, const uint64_t firstElementId,
+									 const VertIdType* nodes, const size_t count)
+{
+	// Format straight into the block, then trim it to what was written
+	const size_t offset = block.size();
+	block.resize(offset + count * MaxElementChars(mNodesPerElement));
+	char* const begin = &block[0];
+	char* out = begin + offset;
+	for (size_t i = 0; i < count; ++i, nodes += mNodesPerElement)
+	{
+		*out++ = '\t';
+		out = FormatUInt(out, firstElementId + i);
+		for (uint32_t n = 0; n < mNodesPerElement; ++n)
+		{
+			memcpy(out, kSep, kSepLength);
+			out = FormatUInt(out + kSepLength, static_cast<uint64_t>(nodes[n]) + 1);
+		}
+		*out++ = '\n';
+	}
+	block.resize(out - begin);
+}
+
+void AsciiMeshFormat::AppendNodes(std::string& block, const uint64_t firstNodeId,
+								  const Vec3* nodes, const size_t count)
+{
+	const size_t offset = block.size();
+	block.resize(offset + count * kMaxNodeChars);
+	char* const begin = &block[0];
+	char* out = begin + offset;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Vec3& v = nodes[i];
+		*out++ = '\t';
+		out = FormatUInt(out, firstNodeId + i + 1);
+		memcpy(out, kSep, kSepLength);
+		out = FormatFloat(out + kSepLength, v.x);
+		memcpy(out, kSep, kSepLength);
+		out = FormatFloat(out + kSepLength, v.y);
+		memcpy(out, kSep, kSepLength);
+		out = FormatFloat(out + kSepLength, v.z);
+		*out++ = '\n';
+	}
+	block.resize(out - begin);
+}
+
+void AsciiMeshFormat::AppendConstraints(std::string& block, const VertIdType* records, const size_t count)
+{
+	const size_t offset = block.size();
+	block.resize(offset + count * kMaxConstraintChars);
+	char* const begin = &block[0];
+	char* out = begin + offset;
+	for (size_t i = 0; i < count; ++i, records += kConstraintValues)
+	{
+		*out++ = '\t';
+		out = FormatUInt(out, static_cast<uint64_t>(records[0]) + 1);
+		for (uint32_t n = 1; n < kConstraintValues && records[n] != kNoConstraintNode; ++n)
+		{
+			memcpy(out, kSep, kSepLength);
+			out = FormatUInt(out + kSepLength, static_cast<uint64_t>(records[n]) + 1);
+		}
+		*out++ = '\n';
+	}
+	block.resize(out - begin);
+}
+
+void AsciiMeshFormat::AppendInterface(std::string& block, const VertIdType* records, const size_t count)
+{
+	const size_t offset = block.size();
+	block.resize(offset + count * kMaxInterfaceChars);
+	char* const begin = &block[0];
+	char* out = begin + offset;
+	for (size_t i = 0; i < count; ++i, records += kInterfaceValues)
+	{
+		*out++ = '\t';
+		out = FormatUInt(out, static_cast<uint64_t>(records[0]) + 1);
+		memcpy(out, kSep, kSepLength);
+		out = FormatUInt(out + kSepLength, static_cast<uint64_t>(records[1]) + 1);
+		memcpy(out, kSep, kSepLength);
+		out = FormatUInt(out + kSepLength, static_cast<uint64_t>(records[2]));
+		*out++ = '\n';
+	}
+	block.resize(out - begin);
+}
+
+BinaryMeshFormat::BinaryMeshFormat(const uint32_t width, const uint32_t height, const uint32_t depth)
+{
+	mDims[0] = width;
+	mDims[1] = height;
+	mDims[2] = depth;
+
+	// Every node is a lattice point, so this bounds the largest node ID
+	const uint64_t maxNodes = (static_cast<uint64_t>(width) + 1) *
+							  (static_cast<uint64_t>(height) + 1) *
+							  (static_cast<uint64_t>(depth) + 1);
+	mIndexWidth = (maxNodes <= 0xFFFFFFFFull) ? 4 : 8;
+}
+
+BinaryMeshHeader BinaryMeshFormat::MakeHeader(const char* magic, const uint32_t valuesPerRecord,
+											  const uint32_t indexWidth, const uint64_t count) const
+{
+	BinaryMeshHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, magic, sizeof(header.magic));
+	header.version = kBinaryMeshVersion;
+	header.endianTag = kBinaryMeshEndianTag;
+	memcpy(header.dims, mDims, sizeof(header.dims));
+	header.valuesPerRecord = valuesPerRecord;
+	header.indexWidth = indexWidth;
+	header.count = count;
+	header.dataOffset = sizeof(BinaryMeshHeader);
+	return header;
+}
+
+void BinaryMeshFormat::RewriteHeader(std::ostream& os, const BinaryMeshHeader& header) const
+{
+	os.seekp(0);
+	os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	os.seekp(0, std::ios::end);
+}
+
+void BinaryMeshFormat::BeginNodes(std::ostream& os)
+{
+	// The node count isn't known yet. EndNodes() rewrites the header.
+	const BinaryMeshHeader header = MakeHeader("B2VNODES", 3, 4, 0);
+	os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void BinaryMeshFormat::EndNodes(std::ostream& os, const uint64_t nodeCount)
+{
+	RewriteHeader(os, MakeHeader("B2VNODES", 3, 4, nodeCount));
+}
+
+void BinaryMeshFormat::BeginIndices(std::ostream& os)
+{
+	// The element count isn't known yet. EndIndices() rewrites the header.
+	const BinaryMeshHeader header = MakeHeader("B2VELEMS", mNodesPerElement, mIndexWidth, 0);
+	os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void BinaryMeshFormat::EndIndices(std::ostream& os, const uint64_t elementCount)
+{
+	RewriteHeader(os, MakeHeader("B2VELEMS", mNodesPerElement, mIndexWidth, elementCount));
+}
+
+void BinaryMeshFormat::AppendNodes(std::string& block, const uint64_t /*firstNodeId*/,
+								   const Vec3* nodes, const size_t count)
+{
+	// Vec3 is three packed floats
+	static_assert(sizeof(Vec3) == 3 * sizeof(float), "Vec3 must be three packed floats");
+	block.append(reinterpret_cast<const char*>(nodes), count * sizeof(Vec3));
+}
+
+void BinaryMeshFormat::AppendElements(std::string& block, const uint64_t /*firstElementId*/,
+									  const VertIdType* nodes, const size_t count)
+{
+	AppendIds(block, nodes, mNodesPerElement * count);
+}
+
+void BinaryMeshFormat::BeginConstraints(std::ostream& os)
+{
+	// The constraint count isn't known yet. EndConstraints() rewrites the header.
+	const BinaryMeshHeader header = MakeHeader("B2VHANGS", kConstraintValues, mIndexWidth, 0);
+	os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void BinaryMeshFormat::EndConstraints(std::ostream& os, const uint64_t constraintCount)
+{
+	RewriteHeader(os, MakeHeader("B2VHANGS", kConstraintValues, mIndexWidth, constraintCount));
+}
+
+void BinaryMeshFormat::AppendConstraints(std::string& block, const VertIdType* records, const size_t count)
+{
+	// kNoConstraintNode narrows to all ones at either index width
+	AppendIds(block, records, kConstraintValues * count);
+}
+
+void BinaryMeshFormat::BeginInterface(std::ostream& os)
+{
+	// The record count isn't known yet. EndInterface() rewrites the header.
+	const BinaryMeshHeader header = MakeHeader("B2VIFACE", kInterfaceValues, mIndexWidth, 0);
+	os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void BinaryMeshFormat::EndInterface(std::ostream& os, const uint64_t recordCount)
+{
+	RewriteHeader(os, MakeHeader("B2VIFACE", kInterfaceValues, mIndexWidth, recordCount));
+}
+
+void BinaryMeshFormat::AppendInterface(std::string& block, const VertIdType* records, const size_t count)
+{
+	AppendIds(block, records, kInterfaceValues * count);
+}
+
+void BinaryMeshFormat::AppendIds(std::string& block, const VertIdType* ids, const size_t numValues) const
+{
+	const size_t offset = block.size();
+	block.resize(offset + numValues * mIndexWidth);
+	char* out = &block[offset];
+
+	if (mIndexWidth == sizeof(VertIdType))
+	{
+		memcpy(out, ids, numValues * sizeof(VertIdType));
+	}
+	else if (mIndexWidth == 8)
+	{
+		for (size_t i = 0; i < numValues; ++i, out += 8)
+		{
+			const uint64_t id = ids[i];
+			memcpy(out, &id, 8);
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < numValues; ++i, out += 4)
+		{
+			const uint32_t id = static_cast<uint32_t>(ids[i]);
+			memcpy(out, &id, 4);
+		}
+	}
+}
+
+MeshFormat* CreateMeshFormat(const std::string& name, const uint32_t width, const uint32_t height, const uint32_t depth)
+{
+	if (name == "ascii")
+		return new AsciiMeshFormat;
+	if (name == "binary")
+		return new BinaryMeshFormat(width, height, depth);
+	return NULL;
+}
+
+// EOF
@@ -0,0 +1,194 @@
+///  @file	MeshFormat.h
+///  @brief	Implements classes: MeshFormat, AsciiMeshFormat, BinaryMeshFormat
+///
+///		Formats the nodes and elements (indices) of the cube-lattice for output.
+///
+///		ascii:  one tab/comma separated line per node or element, with 1-based
+///		        IDs. This is the original bmp2vox format.
+///
+///		binary: a 64-byte BinaryMeshHeader followed by one packed array. The
+///		        nodes file holds float32 (x, y, z) triples, the indices file
+///		        holds 8 node IDs per element (4 or 3 per face of a surface,
+///		        see valuesPerRecord) as uint32 or uint64 (see
+///		        BinaryMeshHeader::indexWidth). Node IDs are 0-based, elements
+///		        are numbered by their position in the file, and the array
+///		        starts at byte 64 so a consumer can mmap the file and use the
+///		        array in place. Values are in the writer's native byte order;
+///		        endianTag tells a reader whether it needs to swap.
+///
+///		An adaptive mesh (--adaptive) also has a constraints file of hanging
+///     nodes: nodes in the middle of an edge or face of a larger element,
+///     whose value is the average of that edge's 2 or that face's 4 corner
+///     nodes. In ascii each line is the hanging node's ID followed by the IDs
+///     it averages; in binary each record is kConstraintValues IDs, padded
+///     with kNoConstraintNode.
+///
+///		A partitioned mesh (--partitions) also has an interface map per
+///     partition: a record per node it shares with another partition, and
+///     partition it shares it with. Each record is the node's ID, its global
+///     ID and the other partition (kInterfaceValues values). In ascii the IDs
+///     are 1-based and the partition is 0-based, as in the file names.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <ios>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "VertPool.h" // Vec3, VertIdType
+
+struct BinaryMeshHeader
+{
+	char     magic[8];          // "B2VNODES", "B2VELEMS", "B2VHANGS" (constraints) or "B2VIFACE" (interface map)
+	uint32_t version;           // kBinaryMeshVersion
+	uint32_t endianTag;         // kBinaryMeshEndianTag, as written by the producer
+	uint32_t dims[3];           // stack width, height and depth in voxels
+	uint32_t valuesPerRecord;   // 3 for nodes (x, y, z), 8 for elements (4 or 3 for surface faces), kConstraintValues for constraints,
+								// kInterfaceValues for an interface map
+	uint32_t indexWidth;        // bytes per value: 4 (float32 coords, uint32 IDs) or 8 (uint64 IDs)
+	uint32_t reserved0;
+	uint64_t count;             // number of nodes, elements or constraints in the file
+	uint64_t dataOffset;        // byte offset of the array (sizeof(BinaryMeshHeader))
+	uint64_t reserved1;
+};
+
+static_assert(sizeof(BinaryMeshHeader) == 64, "BinaryMeshHeader must stay 64 bytes");
+
+const uint32_t kBinaryMeshVersion   = 1;
+const uint32_t kBinaryMeshEndianTag = 0x01020304;
+
+// A hanging-node constraint: the node, then the 2 or 4 nodes it is the average of, padded with kNoConstraintNode
+const uint32_t kConstraintValues = 5;
+const VertIdType kNoConstraintNode = ~static_cast<VertIdType>(0);
+
+// An interface map record: the node, its global ID, and the partition it is shared with
+const uint32_t kInterfaceValues = 3;
+
+class MeshFormat
+{
+public:
+	MeshFormat() : mNodesPerElement(8) {}
+	virtual ~MeshFormat() {}
+
+	// 8 for hexahedra (the default), 4 or 3 for the quads or triangles of a surface (--surface)
+	void SetNodesPerElement(const uint32_t nodesPerElement) { mNodesPerElement = nodesPerElement; }
+	uint32_t GetNodesPerElement() const { return mNodesPerElement; }
+
+	virtual std::ios::openmode GetOpenMode() const = 0;
+	virtual const char* GetFileExtension() const = 0;
+
+	// The ID the files give node 0, and global ID 0 of an interface map: 1 for ascii, 0 for binary
+	virtual uint64_t GetFirstNodeId() const = 0;
+
+	// Called once when the nodes file is opened, and once after the last node has been written
+	virtual void BeginNodes(std::ostream& os) = 0;
+	virtual void EndNodes(std::ostream& os, const uint64_t nodeCount) = 0;
+
+	// Called once when the indices file is opened, and once after the last element has been written
+	virtual void BeginIndices(std::ostream& os) = 0;
+	virtual void EndIndices(std::ostream& os, const uint64_t elementCount) = 0;
+
+	// Appends count nodes to block. Node IDs are consecutive, starting at firstNodeId (0-based).
+	virtual void AppendNodes(std::string& block, const uint64_t firstNodeId,
+							 const Vec3* nodes, const size_t count) = 0;
+
+	// Appends count elements to block. nodes holds GetNodesPerElement() 0-based node IDs per element, in output order.
+	// Element IDs are consecutive, starting at firstElementId (1-based).
+	virtual void AppendElements(std::string& block, const uint64_t firstElementId,
+								const VertIdType* nodes, const size_t count) = 0;
+
+	// Called once when the constraints file is opened, and once after the last constraint has been written
+	virtual void BeginConstraints(std::ostream& os) = 0;
+	virtual void EndConstraints(std::ostream& os, const uint64_t constraintCount) = 0;
+
+	// Appends count constraints to block. records holds kConstraintValues 0-based node IDs per constraint.
+	virtual void AppendConstraints(std::string& block, const VertIdType* records, const size_t count) = 0;
+
+	// Called once when an interface map is opened, and once after its last record has been written
+	virtual void BeginInterface(std::ostream& os) = 0;
+	virtual void EndInterface(std::ostream& os, const uint64_t recordCount) = 0;
+
+	// Appends count records to block. records holds kInterfaceValues values per record: the 0-based node ID,
+	// its 0-based global ID, and the partition.
+	virtual void AppendInterface(std::string& block, const VertIdType* records, const size_t count) = 0;
+
+protected:
+	uint32_t mNodesPerElement;
+};
+
+class AsciiMeshFormat : public MeshFormat
+{
+public:
+	virtual std::ios::openmode GetOpenMode() const { return std::ios::out; }
+	virtual const char* GetFileExtension() const { return ".txt"; }
+	virtual uint64_t GetFirstNodeId() const { return 1; }
+
+	virtual void BeginNodes(std::ostream&) {}
+	virtual void EndNodes(std::ostream&, const uint64_t) {}
+
+	virtual void BeginIndices(std::ostream&) {}
+	virtual void EndIndices(std::ostream&, const uint64_t) {}
+
+	virtual void AppendNodes(std::string& block, const uint64_t firstNodeId,
+							 const Vec3* nodes, const size_t count);
+	virtual void AppendElements(std::string& block, const uint64_t firstElementId,
+								const VertIdType* nodes, const size_t count);
+
+	virtual void BeginConstraints(std::ostream&) {}
+	virtual void EndConstraints(std::ostream&, const uint64_t) {}
+	virtual void AppendConstraints(std::string& block, const VertIdType* records, const size_t count);
+
+	virtual void BeginInterface(std::ostream&) {}
+	virtual void EndInterface(std::ostream&, const uint64_t) {}
+	virtual void AppendInterface(std::string& block, const VertIdType* records, const size_t count);
+};
+
+class BinaryMeshFormat : public MeshFormat
+{
+public:
+	BinaryMeshFormat(const uint32_t width, const uint32_t height, const uint32_t depth);
+
+	virtual std::ios::openmode GetOpenMode() const { return std::ios::out | std::ios::binary; }
+	virtual const char* GetFileExtension() const { return ".bin"; }
+	virtual uint64_t GetFirstNodeId() const { return 0; }
+
+	virtual void BeginNodes(std::ostream& os);
+	virtual void EndNodes(std::ostream& os, const uint64_t nodeCount);
+
+	virtual void BeginIndices(std::ostream& os);
+	virtual void EndIndices(std::ostream& os, const uint64_t elementCount);
+
+	virtual void AppendNodes(std::string& block, const uint64_t firstNodeId,
+							 const Vec3* nodes, const size_t count);
+	virtual void AppendElements(std::string& block, const uint64_t firstElementId,
+								const VertIdType* nodes, const size_t count);
+
+	virtual void BeginConstraints(std::ostream& os);
+	virtual void EndConstraints(std::ostream& os, const uint64_t constraintCount);
+	virtual void AppendConstraints(std::string& block, const VertIdType* records, const size_t count);
+
+	virtual void BeginInterface(std::ostream& os);
+	virtual void EndInterface(std::ostream& os, const uint64_t recordCount);
+	virtual void AppendInterface(std::string& block, const VertIdType* records, const size_t count);
+
+	uint32_t GetIndexWidth() const { return mIndexWidth; }
+
+protected:
+	BinaryMeshHeader MakeHeader(const char* magic, const uint32_t valuesPerRecord,
+								const uint32_t indexWidth, const uint64_t count) const;
+	void RewriteHeader(std::ostream& os, const BinaryMeshHeader& header) const;
+	void AppendIds(std::string& block, const VertIdType* ids, const size_t numValues) const;
+
+	uint32_t mDims[3];
+	uint32_t mIndexWidth;
+};
+
+// Returns NULL for an unknown format name ("ascii" and "binary" are known)
+MeshFormat* CreateMeshFormat(const std::string& name, const uint32_t width, const uint32_t height, const uint32_t depth);
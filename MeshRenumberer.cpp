@@ -0,0 +1,573 @@
+///  @file	MeshRenumberer.cpp
+///  @brief	Implements class: MeshRenumberer
+///
+///		Renumbers a mesh along a space-filling curve or by reverse Cuthill-McKee. See MeshRenumberer.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "MeshRenumberer.h"
+#include "ExternalSorter.h"
+#include "MappedFile.h"
+#include "OccupancySlice.h" // HighestSetBit
+
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+
+namespace
+{
+	const size_t kChunkRecords = 1 << 16;   // records read or formatted at a time
+
+	struct NodeRecord
+	{
+		uint64_t key;
+		uint64_t oldId;
+		Vec3 position;
+
+		bool operator<(const NodeRecord& other) const { return key < other.key || (key == other.key && oldId < other.oldId); }
+	};
+
+	struct MapRecord
+	{
+		uint64_t oldId;
+		uint64_t newId;
+
+		bool operator<(const MapRecord& other) const { return oldId < other.oldId; }
+	};
+
+	struct ElementRecord
+	{
+		uint64_t key;       // the element's lowest new node ID
+		uint64_t oldIndex;  // keeps elements with the same key in their original order
+		VertIdType ids[8];
+
+		bool operator<(const ElementRecord& other) const { return key < other.key || (key == other.key && oldIndex < other.oldIndex); }
+	};
+
+	bool ReadHeader(std::istream& is, const char* magic, BinaryMeshHeader& header)
+	{
+		is.read(reinterpret_cast<char*>(&header), sizeof(header));
+		return is.good() && memcmp(header.magic, magic, sizeof(header.magic)) == 0 &&
+			   header.version == kBinaryMeshVersion && header.endianTag == kBinaryMeshEndianTag;
+	}
+
+	// Reads count IDs of indexWidth bytes each into ids
+	bool ReadIds(std::istream& is, const uint32_t indexWidth, VertIdType* ids, const size_t count, std::vector<char>& bytes)
+	{
+		bytes.resize(count * indexWidth);
+		is.read(bytes.data(), bytes.size());
+		if (static_cast<size_t>(is.gcount()) != bytes.size())
+			return false;
+
+		if (indexWidth == sizeof(VertIdType))
+		{
+			memcpy(ids, bytes.data(), bytes.size());
+			return true;
+		}
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint32_t id;
+			memcpy(&id, &bytes[4 * i], 4);
+			ids[i] = (id == 0xFFFFFFFFu) ? kNoConstraintNode : id;
+		}
+		return true;
+	}
+
+	// Bits of v, 3 apart
+	uint64_t SpreadBits(const uint32_t v)
+	{
+		uint64_t x = v & 0x1FFFFF;
+		x = (x | x << 32) & 0x1F00000000FFFFull;
+		x = (x | x << 16) & 0x1F0000FF0000FFull;
+		x = (x | x << 8) & 0x100F00F00F00F00Full;
+		x = (x | x << 4) & 0x10C30C30C30C30C3ull;
+		x = (x | x << 2) & 0x1249249249249249ull;
+		return x;
+	}
+
+	uint32_t LatticeCoordinate(const float position, const float spacing)
+	{
+		return static_cast<uint32_t>(std::max(0L, std::lround(position / spacing)));
+	}
+
+	// A node of the plane being numbered by OrderByPlanes()
+	struct PlaneNode
+	{
+		uint64_t parent;    // the lowest number of a node of the previous plane at one of its 9 nearest points
+		uint64_t point;     // x + planeDims[0] * y within the plane
+		NodeRecord record;
+
+		bool operator<(const PlaneNode& other) const { return parent < other.parent || (parent == other.parent && point < other.point); }
+	};
+
+	// For kRcm: nodes are keyed by plane, then by point within it, of planeDims lattice points. Numbers them
+	// by Cuthill-McKee with the planes as levels, and adds them to ordered keyed by the reverse of that
+	// number. Returns false if a sort fails.
+	bool OrderByPlanes(ExternalSorter<NodeRecord>& nodes, const uint32_t planeDims[2], const uint64_t numNodes,
+					   ExternalSorter<NodeRecord>& ordered)
+	{
+		const uint64_t kNone = ~0ull;
+		const uint64_t planePoints = static_cast<uint64_t>(planeDims[0]) * planeDims[1];
+
+		// The numbers of the nodes of the previous plane and of the plane being numbered, by point. The
+		// points of the previous plane's nodes are kept to clear it with.
+		std::vector<uint64_t> previous(static_cast<size_t>(planePoints), kNone);
+		std::vector<uint64_t> current(static_cast<size_t>(planePoints), kNone);
+		std::vector<uint64_t> previousPoints;
+		uint64_t previousIndex = 0;
+		bool hasPrevious = false;
+
+		std::vector<PlaneNode> plane;
+		uint64_t planeIndex = 0;
+		uint64_t number = 0;
+		bool added = true;
+		auto numberPlane = [&]() {
+			const bool adjacent = hasPrevious && previousIndex + 1 == planeIndex;
+			for (auto node = plane.begin(); node != plane.end(); ++node)
+			{
+				node->parent = kNone;
+				const int64_t x = static_cast<int64_t>(node->point % planeDims[0]);
+				const int64_t y = static_cast<int64_t>(node->point / planeDims[0]);
+				for (int64_t ny = std::max<int64_t>(y - 1, 0); adjacent && ny <= std::min<int64_t>(y + 1, planeDims[1] - 1); ++ny)
+				{
+					for (int64_t nx = std::max<int64_t>(x - 1, 0); nx <= std::min<int64_t>(x + 1, planeDims[0] - 1); ++nx)
+						node->parent = std::min(node->parent, previous[static_cast<size_t>(ny * planeDims[0] + nx)]);
+				}
+			}
+
+			// Nodes with no parent, where the mesh starts or widens, follow the rest in raster order
+			std::sort(plane.begin(), plane.end());
+			for (auto node = plane.begin(); node != plane.end(); ++node)
+			{
+				current[static_cast<size_t>(node->point)] = number;
+				NodeRecord record = node->record;
+				record.key = numNodes - 1 - number++;
+				added = ordered.Add(record) && added;
+			}
+
+			for (auto point = previousPoints.begin(); point != previousPoints.end(); ++point)
+				previous[static_cast<size_t>(*point)] = kNone;
+			previousPoints.clear();
+			for (auto node = plane.begin(); node != plane.end(); ++node)
+				previousPoints.push_back(node->point);
+			previous.swap(current);
+			previousIndex = planeIndex;
+			hasPrevious = true;
+			plane.clear();
+		};
+
+		const bool merged = nodes.Merge([&](const NodeRecord& record) {
+			const uint64_t index = record.key / planePoints;
+			if (!plane.empty() && index != planeIndex)
+				numberPlane();
+			planeIndex = index;
+			const PlaneNode node = { kNone, record.key % planePoints, record };
+			plane.push_back(node);
+		});
+		if (!plane.empty())
+			numberPlane();
+		return merged && added;
+	}
+}
+
+MeshRenumberer::MeshRenumberer(const Order order, const float spacing, const size_t memoryBytes)
+: mOrder(order),
+  mSpacing(spacing),
+  mMemoryBytes(memoryBytes),
+  mKeyBits(1),
+  mNodeCount(0),
+  mElementCount(0),
+  mConstraintCount(0)
+{
+	mBefore.bandwidth = mBefore.profile = mBefore.medianSpan = 0;
+	mAfter = mBefore;
+}
+
+uint64_t MeshRenumberer::MortonKey(const uint32_t x, const uint32_t y, const uint32_t z)
+{
+	return SpreadBits(x) | (SpreadBits(y) << 1) | (SpreadBits(z) << 2);
+}
+
+uint64_t MeshRenumberer::HilbertKey(const uint32_t x, const uint32_t y, const uint32_t z, const int bits)
+{
+	// Skilling's transform of the coordinates to the transposed Hilbert index, which is then interleaved
+	uint32_t axes[3] = { x, y, z };
+	const uint32_t top = 1u << (bits - 1);
+	for (uint32_t q = top; q > 1; q >>= 1)
+	{
+		const uint32_t p = q - 1;
+		for (int i = 0; i < 3; ++i)
+		{
+			if (axes[i] & q)
+				axes[0] ^= p;
+			else
+			{
+				const uint32_t t = (axes[0] ^ axes[i]) & p;
+				axes[0] ^= t;
+				axes[i] ^= t;
+			}
+		}
+	}
+	axes[1] ^= axes[0];
+	axes[2] ^= axes[1];
+	uint32_t t = 0;
+	for (uint32_t q = top; q > 1; q >>= 1)
+	{
+		if (axes[2] & q)
+			t ^= q - 1;
+	}
+	for (int i = 0; i < 3; ++i)
+		axes[i] ^= t;
+
+	uint64_t key = 0;
+	for (int b = bits - 1; b >= 0; --b)
+		key = (key << 3) | (((axes[0] >> b) & 1) << 2) | (((axes[1] >> b) & 1) << 1) | ((axes[2] >> b) & 1);
+	return key;
+}
+
+bool MeshRenumberer::Renumber(const std::string& nodesIn, const std::string& indicesIn, const std::string& constraintsIn,
+							  MeshFormat& format, std::ostream& nodesOut, std::ostream& indicesOut, std::ostream* constraintsOut,
+							  const uint64_t firstElementId, const std::string& tempPrefix)
+{
+	const std::string mapFilename = tempPrefix + ".map";
+	if (!RenumberNodes(nodesIn, format, nodesOut, mapFilename, tempPrefix))
+	{
+		std::remove(mapFilename.c_str());
+		return false;
+	}
+
+	// An empty mesh has no map, and no IDs to look up in it
+	MappedFile map;
+	if (mNodeCount > 0 && !map.Open(mapFilename.c_str()))
+	{
+		std::remove(mapFilename.c_str());
+		return false;
+	}
+	const VertIdType* newIds = reinterpret_cast<const VertIdType*>(map.GetData());
+
+	bool renumbered = RenumberElements(indicesIn, newIds, format, indicesOut, firstElementId, tempPrefix);
+	if (renumbered && !constraintsIn.empty() && constraintsOut)
+		renumbered = RenumberConstraints(constraintsIn, newIds, format, *constraintsOut);
+
+	map.Close();
+	std::remove(mapFilename.c_str());
+	return renumbered;
+}
+
+bool MeshRenumberer::RenumberNodes(const std::string& nodesIn, MeshFormat& format, std::ostream& nodesOut,
+								   const std::string& mapFilename, const std::string& tempPrefix)
+{
+	std::ifstream in(nodesIn.c_str(), std::ios::in | std::ios::binary);
+	BinaryMeshHeader header;
+	if (!ReadHeader(in, "B2VNODES", header))
+		return false;
+	mNodeCount = header.count;
+
+	// Enough bits for the corner nodes of the last voxel on each axis
+	const uint32_t extent = std::max(header.dims[0], std::max(header.dims[1], header.dims[2])) + 1;
+	for (mKeyBits = 1; mKeyBits < 21 && (1u << mKeyBits) < extent; ++mKeyBits)
+		;
+
+	// For kRcm, the lattice points on each axis. The planes, the levels, are across the axis whose largest
+	// plane has the fewest nodes, as that bounds the bandwidth, which takes a pass over the nodes to count.
+	// The shorter of the other axes is the faster within them.
+	uint32_t points[3];
+	for (int axis = 0; axis < 3; ++axis)
+		points[axis] = header.dims[axis] + 1;
+	int axes[3] = { 0, 1, 2 };  // the faster axis within a plane, the slower, then the axis across the planes
+	std::vector<Vec3> chunk(kChunkRecords);
+	if (mOrder == kRcm)
+	{
+		std::vector<uint64_t> planeNodes[3];
+		for (int axis = 0; axis < 3; ++axis)
+			planeNodes[axis].resize(points[axis]);
+		const std::streampos start = in.tellg();
+		for (uint64_t first = 0; first < mNodeCount; first += kChunkRecords)
+		{
+			const size_t count = static_cast<size_t>(std::min<uint64_t>(kChunkRecords, mNodeCount - first));
+			in.read(reinterpret_cast<char*>(chunk.data()), count * sizeof(Vec3));
+			if (!in.good())
+				return false;
+			for (size_t i = 0; i < count; ++i)
+			{
+				++planeNodes[0][std::min(LatticeCoordinate(chunk[i].x, mSpacing), points[0] - 1)];
+				++planeNodes[1][std::min(LatticeCoordinate(chunk[i].y, mSpacing), points[1] - 1)];
+				++planeNodes[2][std::min(LatticeCoordinate(chunk[i].z, mSpacing), points[2] - 1)];
+			}
+		}
+		in.seekg(start);
+
+		uint64_t largest[3];
+		for (int axis = 0; axis < 3; ++axis)
+			largest[axis] = *std::max_element(planeNodes[axis].begin(), planeNodes[axis].end());
+		std::sort(axes, axes + 3, [&](const int a, const int b) {
+			return largest[a] > largest[b] || (largest[a] == largest[b] && points[a] < points[b]);
+		});
+		if (points[axes[0]] > points[axes[1]])
+			std::swap(axes[0], axes[1]);
+	}
+	const uint32_t planeDims[2] = { points[axes[0]], points[axes[1]] };
+
+	ExternalSorter<NodeRecord> nodes(tempPrefix + ".nodes", mMemoryBytes / sizeof(NodeRecord));
+	nodes.Reserve(static_cast<size_t>(mNodeCount));
+	for (uint64_t first = 0; first < mNodeCount; first += kChunkRecords)
+	{
+		const size_t count = static_cast<size_t>(std::min<uint64_t>(kChunkRecords, mNodeCount - first));
+		in.read(reinterpret_cast<char*>(chunk.data()), count * sizeof(Vec3));
+		if (!in.good())
+			return false;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const Vec3& p = chunk[i];
+			const uint32_t x = LatticeCoordinate(p.x, mSpacing);
+			const uint32_t y = LatticeCoordinate(p.y, mSpacing);
+			const uint32_t z = LatticeCoordinate(p.z, mSpacing);
+			NodeRecord record = { 0, first + i, p };
+			if (mOrder == kRcm)
+			{
+				const uint32_t c[3] = { x, y, z };
+				uint64_t key = 0;
+				for (int n = 2; n >= 0; --n)
+					key = key * points[axes[n]] + std::min(c[axes[n]], points[axes[n]] - 1);
+				record.key = key;
+			}
+			else
+				record.key = (mOrder == kHilbert) ? HilbertKey(x, y, z, mKeyBits) : MortonKey(x, y, z);
+			if (!nodes.Add(record))
+				return false;
+		}
+	}
+
+	// For kRcm the nodes are numbered a plane at a time, and sorted again into the reverse of that order
+	ExternalSorter<NodeRecord> ordered(tempPrefix + ".ordered", mMemoryBytes / sizeof(NodeRecord));
+	if (mOrder == kRcm)
+	{
+		ordered.Reserve(static_cast<size_t>(mNodeCount));
+		if (!OrderByPlanes(nodes, planeDims, mNodeCount, ordered))
+			return false;
+	}
+	ExternalSorter<NodeRecord>& sorter = (mOrder == kRcm) ? ordered : nodes;
+
+	// Nodes go out in order, numbered as they go. Each old ID's new one is stored in place if the whole
+	// permutation fits in memory, and otherwise sorted back into old ID order.
+	const bool mapInMemory = mNodeCount <= mMemoryBytes / sizeof(VertIdType);
+	std::vector<VertIdType> mapped(mapInMemory ? static_cast<size_t>(mNodeCount) : 0);
+	ExternalSorter<MapRecord> mapSorter(tempPrefix + ".mapsort", mMemoryBytes / sizeof(MapRecord));
+	if (!mapInMemory)
+		mapSorter.Reserve(static_cast<size_t>(mNodeCount));
+	format.BeginNodes(nodesOut);
+	std::string block;
+	chunk.clear();
+	uint64_t newId = 0;
+	bool sorted = true;
+	auto writeNodes = [&]() {
+		block.clear();
+		format.AppendNodes(block, newId - chunk.size(), chunk.data(), chunk.size());
+		nodesOut.write(block.data(), block.size());
+		chunk.clear();
+	};
+	sorted = sorter.Merge([&](const NodeRecord& record) {
+		if (mapInMemory)
+			mapped[static_cast<size_t>(record.oldId)] = newId++;
+		else
+		{
+			const MapRecord entry = { record.oldId, newId++ };
+			sorted = mapSorter.Add(entry) && sorted;
+		}
+		chunk.push_back(record.position);
+		if (chunk.size() == kChunkRecords)
+			writeNodes();
+	}) && sorted;
+	writeNodes();
+	format.EndNodes(nodesOut, mNodeCount);
+	if (!sorted)
+		return false;
+
+	std::ofstream mapFile(mapFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (mapInMemory)
+	{
+		mapFile.write(reinterpret_cast<const char*>(mapped.data()), mapped.size() * sizeof(VertIdType));
+		return mapFile.good();
+	}
+	std::vector<VertIdType> ids;
+	ids.reserve(kChunkRecords);
+	sorted = mapSorter.Merge([&](const MapRecord& entry) {
+		ids.push_back(entry.newId);
+		if (ids.size() == kChunkRecords)
+		{
+			mapFile.write(reinterpret_cast<const char*>(ids.data()), ids.size() * sizeof(VertIdType));
+			ids.clear();
+		}
+	});
+	mapFile.write(reinterpret_cast<const char*>(ids.data()), ids.size() * sizeof(VertIdType));
+	return sorted && mapFile.good();
+}
+
+bool MeshRenumberer::RenumberElements(const std::string& indicesIn, const VertIdType* newIds, MeshFormat& format,
+									  std::ostream& indicesOut, const uint64_t firstElementId, const std::string& tempPrefix)
+{
+	std::ifstream in(indicesIn.c_str(), std::ios::in | std::ios::binary);
+	BinaryMeshHeader header;
+	if (!ReadHeader(in, "B2VELEMS", header) || header.valuesPerRecord > 8)
+		return false;
+	mElementCount = header.count;
+	const uint32_t nodesPerElement = header.valuesPerRecord;
+	format.SetNodesPerElement(nodesPerElement);
+
+	if (!MeasureBand(indicesIn, header.dataOffset, header.indexWidth, nodesPerElement, mElementCount, mBefore))
+		return false;
+
+	ExternalSorter<ElementRecord> elements(tempPrefix + ".elements", mMemoryBytes / sizeof(ElementRecord));
+	elements.Reserve(static_cast<size_t>(mElementCount));
+	std::vector<VertIdType> ids(kChunkRecords * nodesPerElement);
+	std::vector<char> bytes;
+	for (uint64_t first = 0; first < mElementCount; first += kChunkRecords)
+	{
+		const size_t count = static_cast<size_t>(std::min<uint64_t>(kChunkRecords, mElementCount - first));
+		if (!ReadIds(in, header.indexWidth, ids.data(), count * nodesPerElement, bytes))
+			return false;
+		for (size_t i = 0; i < count; ++i)
+		{
+			ElementRecord record;
+			record.oldIndex = first + i;
+			record.key = ~0ull;
+			for (uint32_t n = 0; n < nodesPerElement; ++n)
+			{
+				record.ids[n] = newIds[ids[i * nodesPerElement + n]];
+				record.key = std::min<uint64_t>(record.key, record.ids[n]);
+			}
+			if (!elements.Add(record))
+				return false;
+		}
+	}
+
+	// The renumbered elements also go to a file of plain IDs, to be measured
+	const std::string sortedFilename = tempPrefix + ".sorted";
+	std::ofstream sortedFile(sortedFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	format.BeginIndices(indicesOut);
+	std::string block;
+	ids.clear();
+	uint64_t written = 0;
+	auto writeElements = [&]() {
+		const size_t count = ids.size() / nodesPerElement;
+		block.clear();
+		format.AppendElements(block, firstElementId + written, ids.data(), count);
+		indicesOut.write(block.data(), block.size());
+		sortedFile.write(reinterpret_cast<const char*>(ids.data()), ids.size() * sizeof(VertIdType));
+		written += count;
+		ids.clear();
+	};
+	bool sorted = elements.Merge([&](const ElementRecord& record) {
+		ids.insert(ids.end(), record.ids, record.ids + nodesPerElement);
+		if (ids.size() == kChunkRecords * nodesPerElement)
+			writeElements();
+	});
+	writeElements();
+	format.EndIndices(indicesOut, mElementCount);
+	sortedFile.close();
+
+	sorted = sorted && sortedFile.good() &&
+			 MeasureBand(sortedFilename, 0, sizeof(VertIdType), nodesPerElement, mElementCount, mAfter);
+	std::remove(sortedFilename.c_str());
+	return sorted;
+}
+
+bool MeshRenumberer::RenumberConstraints(const std::string& constraintsIn, const VertIdType* newIds, MeshFormat& format,
+										 std::ostream& constraintsOut)
+{
+	std::ifstream in(constraintsIn.c_str(), std::ios::in | std::ios::binary);
+	BinaryMeshHeader header;
+	if (!ReadHeader(in, "B2VHANGS", header) || header.valuesPerRecord != kConstraintValues)
+		return false;
+	mConstraintCount = header.count;
+
+	// Constraints stay in their order. Only their IDs change.
+	format.BeginConstraints(constraintsOut);
+	std::vector<VertIdType> ids(kChunkRecords * kConstraintValues);
+	std::vector<char> bytes;
+	std::string block;
+	for (uint64_t first = 0; first < mConstraintCount; first += kChunkRecords)
+	{
+		const size_t count = static_cast<size_t>(std::min<uint64_t>(kChunkRecords, mConstraintCount - first));
+		if (!ReadIds(in, header.indexWidth, ids.data(), count * kConstraintValues, bytes))
+			return false;
+		for (size_t i = 0; i < count * kConstraintValues; ++i)
+		{
+			if (ids[i] != kNoConstraintNode)
+				ids[i] = newIds[ids[i]];
+		}
+		block.clear();
+		format.AppendConstraints(block, ids.data(), count);
+		constraintsOut.write(block.data(), block.size());
+	}
+	format.EndConstraints(constraintsOut, mConstraintCount);
+	return true;
+}
+
+bool MeshRenumberer::MeasureBand(const std::string& filename, const uint64_t offset, const uint32_t indexWidth,
+								 const uint32_t nodesPerElement, const uint64_t numElements, Band& band) const
+{
+	band.bandwidth = band.profile = band.medianSpan = 0;
+	uint64_t spans[65] = { 0 };     // elements by the bit length of their span
+
+	// The lowest neighbour of each node of a range, one pass over the elements per range
+	const uint64_t rangeNodes = std::max<uint64_t>(mMemoryBytes / sizeof(uint64_t), 1);
+	std::vector<uint64_t> lowest;
+	std::vector<VertIdType> ids(kChunkRecords * nodesPerElement);
+	std::vector<char> bytes;
+	for (uint64_t rangeFirst = 0; rangeFirst < mNodeCount; rangeFirst += rangeNodes)
+	{
+		const uint64_t rangeEnd = std::min(rangeFirst + rangeNodes, mNodeCount);
+		lowest.resize(static_cast<size_t>(rangeEnd - rangeFirst));
+		for (size_t i = 0; i < lowest.size(); ++i)
+			lowest[i] = rangeFirst + i;
+
+		std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+		in.seekg(static_cast<std::streamoff>(offset));
+		for (uint64_t first = 0; first < numElements; first += kChunkRecords)
+		{
+			const size_t count = static_cast<size_t>(std::min<uint64_t>(kChunkRecords, numElements - first));
+			if (!ReadIds(in, indexWidth, ids.data(), count * nodesPerElement, bytes))
+				return false;
+			for (size_t i = 0; i < count; ++i)
+			{
+				const VertIdType* element = &ids[i * nodesPerElement];
+				const VertIdType lo = *std::min_element(element, element + nodesPerElement);
+				const VertIdType hi = *std::max_element(element, element + nodesPerElement);
+				if (rangeFirst == 0)
+				{
+					band.bandwidth = std::max<uint64_t>(band.bandwidth, hi - lo);
+					++spans[(hi == lo) ? 0 : HighestSetBit(hi - lo) + 1];
+				}
+				for (uint32_t n = 0; n < nodesPerElement; ++n)
+				{
+					if (element[n] >= rangeFirst && element[n] < rangeEnd)
+						lowest[element[n] - rangeFirst] = std::min<uint64_t>(lowest[element[n] - rangeFirst], lo);
+				}
+			}
+		}
+
+		for (size_t i = 0; i < lowest.size(); ++i)
+			band.profile += rangeFirst + i - lowest[i];
+	}
+
+	uint64_t below = 0;
+	for (int bits = 0; bits <= 64 && numElements > 0; ++bits)
+	{
+		below += spans[bits];
+		if (2 * below >= numElements)
+		{
+			band.medianSpan = (bits < 64) ? (1ull << bits) : ~0ull;
+			break;
+		}
+	}
+	return true;
+}
+
+// EOF
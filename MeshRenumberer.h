@@ -0,0 +1,122 @@
+///  @file	MeshRenumberer.h
+///  @brief	Implements class: MeshRenumberer
+///
+///		Renumbers the nodes and elements of a mesh, for --renumber. Nodes
+///     are written in first-touch order, which follows the raster order of
+///     the slices, so the two ends of an element's nodes are a whole plane of
+///     nodes apart. Renumbering puts them in one of two kinds of order, and
+///     the elements in the order of their lowest new node ID:
+///
+///		A space-filling curve through the lattice (Morton or Hilbert) keeps
+///     nodes near each other in the mesh near each other in the solver's
+///     arrays, which suits caches and iterative solvers. It makes the
+///     bandwidth larger, and usually the profile, as the curve crosses
+///     between its blocks.
+///
+///		Reverse Cuthill-McKee reduces the bandwidth and profile, for banded
+///     and skyline solvers. Its levels are the planes of the lattice across
+///     the axis whose largest plane has the fewest nodes, rather than the
+///     levels of a breadth-first search, which would need the whole graph.
+///     Every node is adjacent only to nodes at neighbouring lattice points,
+///     so the nodes are sorted into planes and numbered a plane at a time:
+///     those with a node of the previous plane among their 9 nearest lattice
+///     points in order of the lowest such node's number, then the rest in
+///     raster order. Only two planes are held. The order is then reversed
+///     with a second sort.
+///
+///		The mesh is read back from the binary files the run wrote, and may be
+///     far bigger than memory. Nodes are sorted by curve key or plane with an
+///     ExternalSorter. The old-to-new permutation is sorted back into old ID
+///     order and written to a file, which is mapped while the elements are
+///     translated (they reach for old IDs in nearly ascending order) and
+///     sorted in turn. Every sort holds at most the given memory's worth of
+///     records.
+///
+///		The bandwidth and profile of the node adjacency (nodes that share an
+///     element are adjacent) are measured before and after. The profile
+///     needs the lowest neighbour of every node, so it is measured a range of
+///     nodes at a time, with one pass over the elements per range.
+///     The median span is taken from a histogram of powers of two.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include "MeshFormat.h"
+
+class MeshRenumberer
+{
+public:
+	enum Order
+	{
+		kMorton,
+		kHilbert,
+		kRcm        // reverse Cuthill-McKee, with the lattice planes as levels
+	};
+
+	// Of the symmetric matrix with a non-zero wherever two nodes share an element. A curve order trades a
+	// larger bandwidth (where the curve crosses between its largest blocks) for elements whose nodes are
+	// mostly close together, which the median span shows. kRcm makes the bandwidth and profile smaller.
+	struct Band
+	{
+		uint64_t bandwidth;     // the largest difference between the IDs of two nodes of an element
+		uint64_t profile;       // the sum over nodes of the ID less that of its lowest neighbour
+		uint64_t medianSpan;    // a power of two that at least half the elements' differences are below
+	};
+
+	// Nodes are at spacing * (x, y, z) of the lattice. Each sort, and each range of nodes measured,
+	// holds at most about memoryBytes.
+	MeshRenumberer(const Order order, const float spacing, const size_t memoryBytes);
+
+	// Reads the nodes, indices and (unless constraintsIn is empty) constraints files that BinaryMeshFormat
+	// wrote, and writes them renumbered to the output streams with format, which Begin*() and End*() are
+	// called on. Elements are numbered from firstElementId. Temporary files are named tempPrefix followed by
+	// a suffix, and removed. Returns false if an input can't be read or a temporary file can't be written.
+	bool Renumber(const std::string& nodesIn, const std::string& indicesIn, const std::string& constraintsIn,
+				  MeshFormat& format, std::ostream& nodesOut, std::ostream& indicesOut, std::ostream* constraintsOut,
+				  const uint64_t firstElementId, const std::string& tempPrefix);
+
+	const Band& GetBandBefore() const { return mBefore; }
+	const Band& GetBandAfter() const { return mAfter; }
+
+	uint64_t GetNodeCount() const { return mNodeCount; }
+	uint64_t GetElementCount() const { return mElementCount; }
+	uint64_t GetConstraintCount() const { return mConstraintCount; }
+
+	// The curve keys of lattice point (x, y, z): Morton with 21 bits per axis, Hilbert with bits per axis
+	static uint64_t MortonKey(const uint32_t x, const uint32_t y, const uint32_t z);
+	static uint64_t HilbertKey(const uint32_t x, const uint32_t y, const uint32_t z, const int bits);
+
+protected:
+	// Writes the nodes in order, and the new ID of each old one, in old ID order, to mapFilename
+	bool RenumberNodes(const std::string& nodesIn, MeshFormat& format, std::ostream& nodesOut,
+					   const std::string& mapFilename, const std::string& tempPrefix);
+
+	// newIds holds the new ID of each old one
+	bool RenumberElements(const std::string& indicesIn, const VertIdType* newIds, MeshFormat& format,
+						  std::ostream& indicesOut, const uint64_t firstElementId, const std::string& tempPrefix);
+	bool RenumberConstraints(const std::string& constraintsIn, const VertIdType* newIds, MeshFormat& format,
+							 std::ostream& constraintsOut);
+
+	// Measures the elements of a file of numElements records of nodesPerElement IDs, indexWidth bytes each, from offset
+	bool MeasureBand(const std::string& filename, const uint64_t offset, const uint32_t indexWidth,
+					 const uint32_t nodesPerElement, const uint64_t numElements, Band& band) const;
+
+	const Order mOrder;
+	const float mSpacing;
+	const size_t mMemoryBytes;
+
+	int mKeyBits;               // per axis, enough for every lattice point of the stack
+	Band mBefore;
+	Band mAfter;
+	uint64_t mNodeCount;
+	uint64_t mElementCount;
+	uint64_t mConstraintCount;
+};
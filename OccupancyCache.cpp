@@ -0,0 +1,343 @@
+///  @file	OccupancyCache.cpp
+///  @brief	Implements classes: OccupancyCacheReader, OccupancyCacheWriter
+///
+///		A thresholded stack stored on disk as one bit per voxel. See
+///     OccupancyCache.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "OccupancyCache.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <cstdio>
+#include <boost/filesystem.hpp>
+#include "Fnv1a.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+	const char kMagic[8] = { 'B', '2', 'V', 'O', 'C', 'C', 'U', 'P' };
+	const uint64_t kSliceAlignment = 64;
+
+	uint64_t Hash(const uint64_t hash, const std::string& s)
+	{
+		return Fnv1a(hash, s.c_str(), s.size() + 1); // with the terminator, so "ab","c" != "a","bc"
+	}
+
+	// Hashes what tells one version of a file from another: its size, its modification time to the
+	// nanosecond (100 ns ticks on Windows), and its device and inode (volume and file index) and change
+	// time, which copying a file changes even when the modification time is kept. A file that can't be
+	// read hashes as zeros.
+	uint64_t HashFileVersion(const uint64_t hash, const std::string& filename)
+	{
+		int64_t version[7] = { 0 };     // size, modified s and ns, device, inode, changed s and ns
+#ifdef _WIN32
+		HANDLE file = CreateFileA(filename.c_str(), FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+								  NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+		if (file != INVALID_HANDLE_VALUE)
+		{
+			BY_HANDLE_FILE_INFORMATION info;
+			FILE_BASIC_INFO basic;
+			if (GetFileInformationByHandle(file, &info))
+			{
+				version[0] = (static_cast<int64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+				version[1] = (static_cast<int64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime;
+				version[3] = info.dwVolumeSerialNumber;
+				version[4] = (static_cast<int64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+			}
+			if (GetFileInformationByHandleEx(file, FileBasicInfo, &basic, sizeof(basic)))
+				version[5] = basic.ChangeTime.QuadPart;
+			CloseHandle(file);
+		}
+#else
+		struct stat info;
+		if (stat(filename.c_str(), &info) == 0)
+		{
+#ifdef __APPLE__
+			const struct timespec& modified = info.st_mtimespec;
+			const struct timespec& changed = info.st_ctimespec;
+#else
+			const struct timespec& modified = info.st_mtim;
+			const struct timespec& changed = info.st_ctim;
+#endif
+			version[0] = static_cast<int64_t>(info.st_size);
+			version[1] = static_cast<int64_t>(modified.tv_sec);
+			version[2] = static_cast<int64_t>(modified.tv_nsec);
+			version[3] = static_cast<int64_t>(info.st_dev);
+			version[4] = static_cast<int64_t>(info.st_ino);
+			version[5] = static_cast<int64_t>(changed.tv_sec);
+			version[6] = static_cast<int64_t>(changed.tv_nsec);
+		}
+#endif
+		return Fnv1a(hash, version, sizeof(version));
+	}
+
+	uint64_t SliceBytes(const OccupancyCacheHeader& header)
+	{
+		return static_cast<uint64_t>(header.wordsPerRow) * header.dims[1] * sizeof(uint64_t);
+	}
+}
+
+uint64_t OccupancyCacheFingerprint(const std::vector<std::string>& filenames)
+{
+	uint64_t hash = kFnv1aSeed;
+	for (auto fname = filenames.begin(); fname != filenames.end(); ++fname)
+	{
+		hash = Hash(hash, fs::path(*fname).filename().generic_string());
+		hash = HashFileVersion(hash, *fname);
+	}
+	return hash;
+}
+
+std::string OccupancyCachePath(const std::string& cacheDir, const std::string& inputFolder,
+							   const short threshold, const bool negate)
+{
+	boost::system::error_code ec;
+	fs::path folder = fs::canonical(fs::path(inputFolder), ec);
+	if (ec)
+		folder = fs::absolute(fs::path(inputFolder));
+
+	char name[64];
+	snprintf(name, sizeof(name), "bmp2vox-%016llx-t%d%s.occ",
+			 static_cast<unsigned long long>(Hash(kFnv1aSeed, folder.generic_string())),
+			 static_cast<int>(threshold), negate ? "n" : "");
+	return (fs::path(cacheDir) / name).generic_string();
+}
+
+OccupancyCacheReader::OccupancyCacheReader()
+: mSlices(NULL),
+  mWidth(0),
+  mHeight(0),
+  mDepth(0),
+  mNextSlice(0)
+{
+}
+
+bool OccupancyCacheReader::Open(const std::string& filename, const uint64_t fingerprint, const int depth,
+								const short threshold, const bool negate)
+{
+	mFile.Close();
+	mSlices = NULL;
+	mNextSlice = 0;
+	if (!mFile.Open(filename.c_str()))
+		return false;
+
+	const unsigned char* data = mFile.GetData();
+	const uint64_t size = mFile.GetSize();
+	OccupancyCacheHeader header;
+	if (size < sizeof(header))
+		return false;
+	memcpy(&header, data, sizeof(header));
+
+	if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+		header.version != kOccupancyCacheVersion ||
+		header.endianTag != kOccupancyCacheEndianTag ||
+		header.fingerprint != fingerprint ||
+		header.threshold != threshold ||
+		header.negate != (negate ? 1u : 0u) ||
+		header.dims[2] != static_cast<uint32_t>(depth) ||
+		header.dims[0] == 0 || header.dims[1] == 0 ||
+		header.wordsPerRow != (header.dims[0] + 63) / 64)
+		return false;
+
+	const uint64_t tableBytes = static_cast<uint64_t>(depth) * sizeof(OccupancyCacheSliceEntry);
+	if (header.sliceTableOffset % sizeof(uint64_t) != 0 ||
+		header.sliceTableOffset > size || size - header.sliceTableOffset < tableBytes)
+		return false;
+	const OccupancyCacheSliceEntry* slices = reinterpret_cast<const OccupancyCacheSliceEntry*>(data + header.sliceTableOffset);
+
+	const uint64_t sliceBytes = SliceBytes(header);
+	for (int z = 0; z < depth; ++z)
+	{
+		if (slices[z].status != OccupancySlice::kOk)
+			continue;
+		const int32_t* b = slices[z].bounds;
+		if (slices[z].offset % sizeof(uint64_t) != 0 ||
+			slices[z].offset > size || size - slices[z].offset < sliceBytes)
+			return false;
+		if (b[0] <= b[2] && (b[0] < 0 || b[1] < 0 || b[1] > b[3] ||
+							 b[2] >= static_cast<int32_t>(header.dims[0]) || b[3] >= static_cast<int32_t>(header.dims[1])))
+			return false;
+	}
+
+	mSlices = slices;
+	mWidth = static_cast<int>(header.dims[0]);
+	mHeight = static_cast<int>(header.dims[1]);
+	mDepth = depth;
+	return true;
+}
+
+bool OccupancyCacheReader::GetBounds(int& minX, int& minY, int& maxX, int& maxY) const
+{
+	minX = minY = INT_MAX;
+	maxX = maxY = -1;
+	for (int z = 0; mSlices && z < mDepth; ++z)
+	{
+		const int32_t* b = mSlices[z].bounds;
+		if (mSlices[z].status != OccupancySlice::kOk || b[0] > b[2])
+			continue;
+		minX = std::min(minX, static_cast<int>(b[0]));
+		minY = std::min(minY, static_cast<int>(b[1]));
+		maxX = std::max(maxX, static_cast<int>(b[2]));
+		maxY = std::max(maxY, static_cast<int>(b[3]));
+	}
+	return maxX >= 0;
+}
+
+bool OccupancyCacheReader::Next(OccupancySlice& slice)
+{
+	if (!mSlices || mNextSlice >= mDepth)
+		return false;
+
+	const OccupancyCacheSliceEntry& entry = mSlices[mNextSlice];
+	slice.z = mNextSlice++;
+	slice.status = static_cast<OccupancySlice::Status>(entry.status);
+	if (slice.status == OccupancySlice::kOk)
+	{
+		// Rows outside the foreground bounds are all zero, which is how Resize() leaves them
+		slice.Resize(mWidth, mHeight);
+		if (entry.bounds[0] <= entry.bounds[2])
+		{
+			const size_t rowBytes = static_cast<size_t>(slice.GetWordsPerRow()) * sizeof(uint64_t);
+			const int minY = entry.bounds[1];
+			const int maxY = entry.bounds[3];
+			memcpy(slice.GetRow(minY), mFile.GetData() + entry.offset + minY * rowBytes, (maxY - minY + 1) * rowBytes);
+			slice.UpdateSummary();
+		}
+	}
+	return true;
+}
+
+OccupancyCacheWriter::OccupancyCacheWriter()
+: mNextSlice(0)
+{
+	memset(&mHeader, 0, sizeof(mHeader));
+}
+
+OccupancyCacheWriter::~OccupancyCacheWriter()
+{
+	Discard();
+}
+
+bool OccupancyCacheWriter::Open(const std::string& filename, const uint64_t fingerprint,
+								const int width, const int height, const int depth,
+								const short threshold, const bool negate)
+{
+	Discard();
+
+	memset(&mHeader, 0, sizeof(mHeader));
+	memcpy(mHeader.magic, kMagic, sizeof(kMagic));
+	mHeader.version = kOccupancyCacheVersion;
+	mHeader.endianTag = kOccupancyCacheEndianTag;
+	mHeader.dims[0] = static_cast<uint32_t>(width);
+	mHeader.dims[1] = static_cast<uint32_t>(height);
+	mHeader.dims[2] = static_cast<uint32_t>(depth);
+	mHeader.wordsPerRow = static_cast<uint32_t>((width + 63) / 64);
+	mHeader.threshold = threshold;
+	mHeader.negate = negate ? 1 : 0;
+	mHeader.fingerprint = fingerprint;
+	mHeader.sliceTableOffset = sizeof(OccupancyCacheHeader);
+
+	OccupancyCacheSliceEntry empty;
+	memset(&empty, 0, sizeof(empty));
+	mSlices.assign(depth, empty);
+	mNextSlice = 0;
+
+	mFilename = filename;
+	mTempFilename = filename + ".tmp";
+	mFile.open(mTempFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!mFile.is_open())
+		return false;
+
+	// The slice table is filled in by Commit()
+	mFile.write(reinterpret_cast<const char*>(&mHeader), sizeof(mHeader));
+	mFile.write(reinterpret_cast<const char*>(mSlices.data()), mSlices.size() * sizeof(OccupancyCacheSliceEntry));
+	if (!mFile.good())
+	{
+		Discard();
+		return false;
+	}
+	return true;
+}
+
+void OccupancyCacheWriter::Write(const OccupancySlice& slice)
+{
+	if (!mFile.is_open() || slice.z != mNextSlice || mNextSlice >= static_cast<int>(mSlices.size()))
+		return;
+
+	OccupancyCacheSliceEntry& entry = mSlices[mNextSlice++];
+	entry.status = slice.status;
+	if (slice.status != OccupancySlice::kOk)
+		return;
+
+	int minX, minY, maxX, maxY;
+	slice.GetBounds(minX, minY, maxX, maxY);
+	entry.bounds[0] = minX;
+	entry.bounds[1] = minY;
+	entry.bounds[2] = maxX;
+	entry.bounds[3] = maxY;
+
+	static const char kPadding[kSliceAlignment] = {};
+	const uint64_t pos = static_cast<uint64_t>(mFile.tellp());
+	const uint64_t padding = (kSliceAlignment - pos % kSliceAlignment) % kSliceAlignment;
+	mFile.write(kPadding, padding);
+	entry.offset = pos + padding;
+	mFile.write(reinterpret_cast<const char*>(slice.GetRow(0)), SliceBytes(mHeader));
+}
+
+bool OccupancyCacheWriter::Commit()
+{
+	if (!mFile.is_open() || mNextSlice != static_cast<int>(mSlices.size()))
+	{
+		Discard();
+		return false;
+	}
+
+	mFile.seekp(mHeader.sliceTableOffset);
+	mFile.write(reinterpret_cast<const char*>(mSlices.data()), mSlices.size() * sizeof(OccupancyCacheSliceEntry));
+	mFile.close();
+	if (!mFile)
+	{
+		Discard();
+		return false;
+	}
+
+	boost::system::error_code ec;
+	fs::rename(fs::path(mTempFilename), fs::path(mFilename), ec);
+	if (ec)
+	{
+		Discard();
+		return false;
+	}
+	mTempFilename.clear();
+	return true;
+}
+
+void OccupancyCacheWriter::Discard()
+{
+	if (mFile.is_open())
+		mFile.close();
+	if (!mTempFilename.empty())
+	{
+		boost::system::error_code ec;
+		fs::remove(fs::path(mTempFilename), ec);
+		mTempFilename.clear();
+	}
+}
+
+// EOF
@@ -0,0 +1,134 @@
+///  @file	OccupancyCache.h
+///  @brief	Implements classes: OccupancyCacheReader, OccupancyCacheWriter
+///
+///		A thresholded stack stored on disk as one bit per voxel, so that later
+///     runs over the same bitmaps with the same threshold and negate flag
+///     skip decoding the bitmaps altogether.
+///
+///		The file is an OccupancyCacheHeader, a table of one
+///     OccupancyCacheSliceEntry per slice, then the packed rows of each slice
+///     exactly as OccupancySlice holds them (GetWordsPerRow() 64-bit words per
+///     row, top row first). Slices start on 64-byte boundaries and the
+///     reader maps the file, so a slice is one memcpy of the rows within
+///     its foreground bounds (also in the slice table). The union of those
+///     bounds is the tight bounding box of the whole stack, known before the
+///     first slice is read.
+///
+///		The header records a fingerprint of the bitmaps (names, sizes,
+///     modification and change times to the nanosecond, devices and inodes),
+///     the threshold and the negate flag. A cache that doesn't match is
+///     ignored and rebuilt. A copy, even one that keeps timestamps (cp -p,
+///     rsync -a, tar), has new inodes and change times, so it doesn't match.
+///     What it can miss is a bitmap rewritten in place to the same size
+///     within one tick of the file system's clock (seconds on FAT, ext3 and
+///     some network file systems), or one whose change time was set back,
+///     which Windows allows. Use --no-cache, or delete the cache, after
+///     edits like that. Checkpoints are matched by the same fingerprint. The writer writes to a temporary
+///     file and renames it when complete, so an interrupted run never leaves
+///     a partial cache behind.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "SliceSource.h"
+#include "MappedFile.h"
+
+struct OccupancyCacheHeader
+{
+	char     magic[8];          // "B2VOCCUP"
+	uint32_t version;           // kOccupancyCacheVersion
+	uint32_t endianTag;         // kOccupancyCacheEndianTag, as written by the producer
+	uint32_t dims[3];           // stack width, height and depth in voxels
+	uint32_t wordsPerRow;       // 64-bit words per row, (width + 63) / 64
+	int32_t  threshold;
+	uint32_t negate;
+	uint64_t fingerprint;       // see OccupancyCacheFingerprint()
+	uint64_t sliceTableOffset;  // byte offset of dims[2] OccupancyCacheSliceEntry
+	uint64_t reserved;
+};
+
+static_assert(sizeof(OccupancyCacheHeader) == 64, "OccupancyCacheHeader must stay 64 bytes");
+
+struct OccupancyCacheSliceEntry
+{
+	uint64_t offset;            // byte offset of the slice's rows, 0 if the slice has none
+	uint32_t status;            // OccupancySlice::Status of the slice when it was decoded
+	int32_t  bounds[4];         // foreground minX, minY, maxX, maxY (inclusive; minX > maxX if empty)
+	uint32_t reserved;
+};
+
+static_assert(sizeof(OccupancyCacheSliceEntry) == 32, "OccupancyCacheSliceEntry must stay 32 bytes");
+
+const uint32_t kOccupancyCacheVersion   = 2;
+const uint32_t kOccupancyCacheEndianTag = 0x01020304;
+
+// Hash of the name, size, times, device and inode of every bitmap of the stack, in order
+uint64_t OccupancyCacheFingerprint(const std::vector<std::string>& filenames);
+
+// Where the cache for a stack lives: a file in cacheDir named after the input folder, threshold and negate flag
+std::string OccupancyCachePath(const std::string& cacheDir, const std::string& inputFolder,
+							   const short threshold, const bool negate);
+
+class OccupancyCacheReader : public SliceSource
+{
+public:
+	OccupancyCacheReader();
+
+	// Fails unless the file is a complete cache of depth slices made with this fingerprint, threshold and negate
+	bool Open(const std::string& filename, const uint64_t fingerprint, const int depth,
+			  const short threshold, const bool negate);
+
+	int GetWidth() const { return mWidth; }
+	int GetHeight() const { return mHeight; }
+
+	// The foreground bounding box of the whole stack (inclusive). Returns false if there is no foreground.
+	bool GetBounds(int& minX, int& minY, int& maxX, int& maxY) const;
+
+	virtual bool Next(OccupancySlice& slice);
+	virtual void Seek(const int z) { mNextSlice = z; }
+
+protected:
+	MappedFile mFile;
+	const OccupancyCacheSliceEntry* mSlices;
+	int mWidth;
+	int mHeight;
+	int mDepth;
+	int mNextSlice;
+};
+
+class OccupancyCacheWriter
+{
+public:
+	OccupancyCacheWriter();
+	~OccupancyCacheWriter();    // discards the cache unless Commit() succeeded
+
+	bool Open(const std::string& filename, const uint64_t fingerprint,
+			  const int width, const int height, const int depth,
+			  const short threshold, const bool negate);
+	bool IsOpen() const { return mFile.is_open(); }
+
+	// Slices must be written in stack order
+	void Write(const OccupancySlice& slice);
+
+	// Writes the slice table and moves the finished cache into place
+	bool Commit();
+
+protected:
+	void Discard();
+
+	std::ofstream mFile;
+	std::string mFilename;
+	std::string mTempFilename;
+	std::vector<OccupancyCacheSliceEntry> mSlices;
+	OccupancyCacheHeader mHeader;
+	int mNextSlice;
+};
@@ -0,0 +1,158 @@
+///  @file	OccupancySlice.cpp
+///  @brief	Implements class: OccupancySlice
+///
+///		The thresholded form of one bitmap in the stack. See OccupancySlice.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "OccupancySlice.h"
+
+#include <algorithm>
+
+const int OccupancySlice::kTileSize;
+
+OccupancySlice::OccupancySlice()
+: z(0),
+  status(kOk),
+  mWidth(0),
+  mHeight(0),
+  mWordsPerRow(0),
+  mMinX(0),
+  mMinY(0),
+  mMaxX(-1),
+  mMaxY(-1)
+{
+}
+
+void OccupancySlice::Resize(const int width, const int height)
+{
+	mWidth = width;
+	mHeight = height;
+	mWordsPerRow = (width + 63) / 64;
+	mBits.assign(static_cast<size_t>(mWordsPerRow) * height, 0);
+	ClearSummary();
+}
+
+void OccupancySlice::ClearSummary()
+{
+	mMinX = mMinY = 0;
+	mMaxX = mMaxY = -1;
+	mRowWords.assign(2 * static_cast<size_t>(mHeight), 0);
+	mTiles.assign(static_cast<size_t>(mWordsPerRow) * ((mHeight + kTileSize - 1) / kTileSize), 0);
+	mTileRows.assign((mHeight + kTileSize - 1) / kTileSize, 0);
+}
+
+void OccupancySlice::UpdateSummary()
+{
+	ClearSummary();
+	mMinX = mWidth;
+	mMinY = mHeight;
+	for (int y = 0; y < mHeight; ++y)
+	{
+		const uint64_t* row = GetRow(y);
+		int first = 0;
+		while (first < mWordsPerRow && row[first] == 0)
+			++first;
+		if (first == mWordsPerRow)
+			continue;   // mRowWords stays (0, 0)
+
+		int end = mWordsPerRow;
+		while (row[end - 1] == 0)
+			--end;
+
+		mRowWords[2 * y] = first;
+		mRowWords[2 * y + 1] = end;
+
+		const int ty = y / kTileSize;
+		unsigned char* tiles = &mTiles[static_cast<size_t>(ty) * mWordsPerRow];
+		for (int w = first; w < end; ++w)
+			tiles[w] |= (row[w] != 0) ? 1 : 0;
+		mTileRows[ty] = 1;
+
+		mMinX = std::min(mMinX, 64 * first + CountTrailingZeros(row[first]));
+		mMaxX = std::max(mMaxX, 64 * (end - 1) + HighestSetBit(row[end - 1]));
+		mMinY = std::min(mMinY, y);
+		mMaxY = y;
+	}
+
+	if (mMaxY < 0)
+		ClearSummary();
+}
+
+namespace
+{
+	// The first x in [x, end) whose bit is set (or clear, if inverted), or end if there is none
+	int FindBit(const uint64_t* row, int x, const int end, const uint64_t inverted)
+	{
+		if (x >= end)
+			return end;
+
+		int w = x >> 6;
+		uint64_t bits = (row[w] ^ inverted) & (~0ull << (x & 63));
+		while (bits == 0)
+		{
+			if (64 * ++w >= end)
+				return end;
+			bits = row[w] ^ inverted;
+		}
+		x = 64 * w + CountTrailingZeros(bits);
+		return x < end ? x : end;
+	}
+}
+
+void OccupancySlice::CopyBits(const OccupancySlice& from, const int y, const int begin, const int end)
+{
+	if (begin >= end)
+		return;
+
+	const uint64_t* src = from.GetRow(y);
+	uint64_t* dst = GetRow(y);
+	const int firstWord = begin >> 6;
+	const int lastWord = (end - 1) >> 6;
+	for (int w = firstWord; w <= lastWord; ++w)
+	{
+		uint64_t mask = ~0ull;
+		if (w == firstWord)
+			mask &= ~0ull << (begin & 63);
+		if (w == lastWord && (end & 63))
+			mask &= (1ull << (end & 63)) - 1;
+		dst[w] = (dst[w] & ~mask) | (src[w] & mask);
+	}
+}
+
+void OccupancySlice::ClearBits(const int y, const int begin, const int end)
+{
+	if (begin >= end)
+		return;
+
+	uint64_t* row = GetRow(y);
+	const int firstWord = begin >> 6;
+	const int lastWord = (end - 1) >> 6;
+	for (int w = firstWord; w <= lastWord; ++w)
+	{
+		uint64_t mask = ~0ull;
+		if (w == firstWord)
+			mask &= ~0ull << (begin & 63);
+		if (w == lastWord && (end & 63))
+			mask &= (1ull << (end & 63)) - 1;
+		row[w] &= ~mask;
+	}
+}
+
+void OccupancySlice::AppendRuns(const int y, const int begin, const int end, std::vector<int>& runs) const
+{
+	const uint64_t* row = GetRow(y);
+	for (int x = FindBit(row, begin, end, 0); x < end; )
+	{
+		const int runEnd = FindBit(row, x, end, ~0ull);
+		runs.push_back(x);
+		runs.push_back(runEnd);
+		x = FindBit(row, runEnd, end, 0);
+	}
+}
+
+// EOF
@@ -0,0 +1,133 @@
+///  @file	OccupancySlice.h
+///  @brief	Implements class: OccupancySlice
+///
+///		The thresholded form of one bitmap in the stack: one bit per pixel
+///     that says whether the voxel at (x, y, z) is foreground. Each row is
+///     packed into GetWordsPerRow() 64-bit words, pixel x in bit x%64 of word
+///     x/64, and bits past the width are always clear, so empty stretches of
+///     a row can be skipped a word at a time.
+///
+///		UpdateSummary() records where the foreground is, so that consumers can
+///     skip air without reading it: the bounding box of the slice, the range
+///     of non-zero words of each row, and which kTileSize x kTileSize tiles
+///     hold any foreground. Resize() leaves an empty slice with an empty
+///     summary. Whoever fills the rows calls UpdateSummary() afterwards.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Index of the lowest set bit. word must be non-zero.
+inline int CountTrailingZeros(const uint64_t word)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctzll(word);
+#endif
+}
+
+// Index of the highest set bit. word must be non-zero.
+inline int HighestSetBit(const uint64_t word)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, word);
+	return static_cast<int>(index);
+#else
+	return 63 - __builtin_clzll(word);
+#endif
+}
+
+// Number of set bits
+inline int PopCount(const uint64_t word)
+{
+#ifdef _MSC_VER
+	return static_cast<int>(__popcnt64(word));
+#else
+	return __builtin_popcountll(word);
+#endif
+}
+
+class OccupancySlice
+{
+public:
+	enum Status
+	{
+		kOk,
+		kReadError,     // the bitmap could not be read
+		kSizeMismatch   // the bitmap is not the size of the first bitmap in the stack
+	};
+
+	static const int kTileSize = 64; // one word of a row, by 64 rows
+
+	OccupancySlice();
+
+	void Resize(const int width, const int height);
+
+	inline bool IsSet(const int x, const int y) const { return ((GetRow(y)[x >> 6] >> (x & 63)) & 1) != 0; }
+	inline uint64_t* GetRow(const int y) { return &mBits[static_cast<size_t>(y) * mWordsPerRow]; }
+	inline const uint64_t* GetRow(const int y) const { return &mBits[static_cast<size_t>(y) * mWordsPerRow]; }
+
+	int GetWidth() const { return mWidth; }
+	int GetHeight() const { return mHeight; }
+	int GetWordsPerRow() const { return mWordsPerRow; }
+
+	// Recomputes the bounds, row word ranges and tiles below from the rows. Call once the rows are written.
+	void UpdateSummary();
+
+	// The foreground bounding box, inclusive. Empty slices have minX > maxX.
+	bool IsEmpty() const { return mMaxX < mMinX; }
+	void GetBounds(int& minX, int& minY, int& maxX, int& maxY) const { minX = mMinX; minY = mMinY; maxX = mMaxX; maxY = mMaxY; }
+
+	// Words [GetRowFirstWord(y), GetRowEndWord(y)) of row y hold all of its foreground
+	int GetRowFirstWord(const int y) const { return mRowWords[2 * y]; }
+	int GetRowEndWord(const int y) const { return mRowWords[2 * y + 1]; }
+
+	int GetTilesPerRow() const { return mWordsPerRow; }
+	bool IsTileEmpty(const int tx, const int ty) const { return mTiles[static_cast<size_t>(ty) * mWordsPerRow + tx] == 0; }
+	bool IsTileRowEmpty(const int ty) const { return mTileRows[ty] == 0; }
+
+	// Copies voxels [begin, end) of row y from a slice of the same size. Call UpdateSummary() once done.
+	void CopyBits(const OccupancySlice& from, const int y, const int begin, const int end);
+
+	// Clears voxels [begin, end) of row y. Call UpdateSummary() once done.
+	void ClearBits(const int y, const int begin, const int end);
+
+	// Appends the runs of set voxels of row y within [begin, end) to runs, as ascending
+	// (runBegin, runEnd) pairs. Whole words of background or foreground are skipped at once.
+	void AppendRuns(const int y, const int begin, const int end, std::vector<int>& runs) const;
+
+	int z;          // slice index in the stack
+	Status status;
+
+protected:
+	void ClearSummary();
+
+	std::vector<uint64_t> mBits;
+	int mWidth;
+	int mHeight;
+	int mWordsPerRow;
+
+	int mMinX;
+	int mMinY;
+	int mMaxX;
+	int mMaxY;
+	std::vector<int> mRowWords;             // per row: first non-zero word, and one past the last
+	std::vector<unsigned char> mTiles;      // per tile: any foreground?
+	std::vector<unsigned char> mTileRows;   // per row of tiles: any foreground?
+};
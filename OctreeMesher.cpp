@@ -0,0 +1,405 @@
+///  @file	OctreeMesher.cpp
+///  @brief	Implements class: OctreeMesher
+///
+///		Meshes a stack as a balanced octree of hexahedra. See OctreeMesher.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "OctreeMesher.h"
+
+#include <algorithm>
+
+const int OctreeMesher::kMaxLevel;
+const uint64_t OctreeMesher::NodePlane::kNoKey;
+
+namespace
+{
+	const uint64_t kEvenBits = 0x5555555555555555ull;
+
+	// Corners c = dx + 2 dy + 4 dz of an element, in the order they're written
+	const int kOutputOrder[8] = { 0, 1, 3, 2, 4, 5, 7, 6 };
+
+	// The corners of each edge and each face. A face's centre is halfway between its first and last corners.
+	const int kEdges[12][2] =
+	{
+		{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+		{ 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+		{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
+	};
+	const int kFaces[6][4] =
+	{
+		{ 0, 2, 4, 6 }, { 1, 3, 5, 7 },
+		{ 0, 1, 4, 5 }, { 2, 3, 6, 7 },
+		{ 0, 1, 2, 3 }, { 4, 5, 6, 7 }
+	};
+}
+
+OctreeMesher::OctreeMesher(const int width, const int height, const int maxLevel)
+: mWidth(width),
+  mHeight(height),
+  mMaxLevel(maxLevel),
+  mSlabDepth(1 << maxLevel),
+  mSlices(3 << maxLevel),
+  mSliceZ(3 << maxLevel, -1),
+  mZeroRow((width + 63) / 64, 0),
+  mLastZ(-1),
+  mNextSlab(0),
+  mWindowZ(0),
+  mPlanes(2 * (1 << maxLevel) + 1),
+  mPlaneZ(2 * (1 << maxLevel) + 1, -1),
+  mFirstPendingId(0),
+  mSpacing(1.0f)
+{
+	for (int level = 1; level <= mMaxLevel; ++level)
+	{
+		const int size = 1 << level;
+		mStateDims[level][0] = (mWidth + size - 1) / size;
+		mStateDims[level][1] = (mHeight + size - 1) / size;
+		mStateDims[level][2] = (3 * mSlabDepth) / size;
+		mStates[level].resize(static_cast<size_t>(mStateDims[level][0]) * mStateDims[level][1] * mStateDims[level][2]);
+	}
+}
+
+void OctreeMesher::AddSlice(const OccupancySlice& slice)
+{
+	// The slot is about to be reused, so mesh the slabs whose neighbourhood is complete first
+	while ((mNextSlab + 2) * mSlabDepth <= slice.z)
+		MeshSlab();
+
+	if (slice.status != OccupancySlice::kOk || slice.IsEmpty())
+		return;
+
+	const int slot = slice.z % static_cast<int>(mSlices.size());
+	mSlices[slot] = slice;
+	mSliceZ[slot] = slice.z;
+	mLastZ = slice.z;
+}
+
+void OctreeMesher::Finish()
+{
+	while (mNextSlab * mSlabDepth <= mLastZ)
+		MeshSlab();
+
+	// Nothing comes after the last slab, so every node its candidates could be is known
+	ResolveCandidates(mPrevCandidates);
+	mPrevCandidates.clear();
+}
+
+void OctreeMesher::ClearPendingNodes()
+{
+	mFirstPendingId += mNodes.size();
+	mNodes.clear();
+}
+
+const OccupancySlice* OctreeMesher::GetSlice(const int z) const
+{
+	if (z < 0)
+		return NULL;
+	const int slot = z % static_cast<int>(mSlices.size());
+	return mSliceZ[slot] == z ? &mSlices[slot] : NULL;
+}
+
+void OctreeMesher::MeshSlab()
+{
+	const int slabZ = mNextSlab * mSlabDepth;
+	mWindowZ = slabZ - mSlabDepth;
+	++mNextSlab;
+
+	bool slabEmpty = true;
+	for (int z = slabZ; z < slabZ + mSlabDepth && slabEmpty; ++z)
+		slabEmpty = (GetSlice(z) == NULL);
+
+	if (!slabEmpty)
+	{
+		ComputeStates();
+
+		// The slab is the middle layer of top-level blocks. Each is meshed depth-first, so the
+		// elements of a block are contiguous.
+		const int* dims = mStateDims[mMaxLevel];
+		for (int by = 0; by < dims[1]; ++by)
+		{
+			for (int bx = 0; bx < dims[0]; ++bx)
+				EmitBlock(mMaxLevel, bx, by, 1);
+		}
+	}
+
+	// This slab's elements were the last that could touch the candidates of the slab before it
+	ResolveCandidates(mPrevCandidates);
+	mPrevCandidates.swap(mCandidates);
+	mCandidates.clear();
+}
+
+void OctreeMesher::ComputeStates()
+{
+	// Level 1 from the voxels, a word (32 blocks) at a time: a block is solid if both voxels of each
+	// of its four row pairs are set, and empty if none are
+	{
+		const int* dims = mStateDims[1];
+		std::fill(mStates[1].begin(), mStates[1].end(), static_cast<unsigned char>(kEmpty));
+		for (int bz = 0; bz < dims[2]; ++bz)
+		{
+			const OccupancySlice* slices[2] = { GetSlice(mWindowZ + 2 * bz), GetSlice(mWindowZ + 2 * bz + 1) };
+			if (!slices[0] && !slices[1])
+				continue;
+
+			for (int by = 0; by < dims[1]; ++by)
+			{
+				const uint64_t* rows[4];
+				int firstWord = static_cast<int>(mZeroRow.size());
+				int endWord = 0;
+				for (int r = 0; r < 4; ++r)
+				{
+					const OccupancySlice* slice = slices[r >> 1];
+					const int y = 2 * by + (r & 1);
+					rows[r] = mZeroRow.data();
+					if (slice && y < mHeight && slice->GetRowFirstWord(y) < slice->GetRowEndWord(y))
+					{
+						rows[r] = slice->GetRow(y);
+						firstWord = std::min(firstWord, slice->GetRowFirstWord(y));
+						endWord = std::max(endWord, slice->GetRowEndWord(y));
+					}
+				}
+
+				unsigned char* states = &mStates[1][(static_cast<size_t>(bz) * dims[1] + by) * dims[0]];
+				for (int w = firstWord; w < endWord; ++w)
+				{
+					const uint64_t all = rows[0][w] & rows[1][w] & rows[2][w] & rows[3][w];
+					const uint64_t any = rows[0][w] | rows[1][w] | rows[2][w] | rows[3][w];
+					const uint64_t solid = all & (all >> 1) & kEvenBits;
+					for (uint64_t bits = (any | (any >> 1)) & kEvenBits; bits != 0; bits &= bits - 1)
+					{
+						const int bit = CountTrailingZeros(bits);
+						states[32 * w + (bit >> 1)] = ((solid >> bit) & 1) ? kSolid : kPartial;
+					}
+				}
+			}
+		}
+	}
+
+	// Higher levels from the level below. A block whose children are all solid is only solid if
+	// none of the 56 half-size blocks around them will be split, so no element that touches it is
+	// less than half its size.
+	for (int level = 2; level <= mMaxLevel; ++level)
+	{
+		const int* dims = mStateDims[level];
+		unsigned char* states = mStates[level].data();
+		for (int bz = 0; bz < dims[2]; ++bz)
+		{
+			for (int by = 0; by < dims[1]; ++by)
+			{
+				for (int bx = 0; bx < dims[0]; ++bx, ++states)
+				{
+					int numSolid = 0;
+					int numEmpty = 0;
+					for (int c = 0; c < 8; ++c)
+					{
+						const unsigned char child = GetState(level - 1, 2 * bx + (c & 1), 2 * by + ((c >> 1) & 1), 2 * bz + (c >> 2));
+						numSolid += (child == kSolid) ? 1 : 0;
+						numEmpty += (child == kEmpty) ? 1 : 0;
+					}
+
+					if (numEmpty == 8)
+						*states = kEmpty;
+					else if (numSolid < 8)
+						*states = kPartial;
+					else
+					{
+						bool balanced = true;
+						for (int k = -1; k <= 2 && balanced; ++k)
+						{
+							for (int j = -1; j <= 2 && balanced; ++j)
+							{
+								for (int i = -1; i <= 2 && balanced; ++i)
+								{
+									if ((i == 0 || i == 1) && (j == 0 || j == 1) && (k == 0 || k == 1))
+										continue;
+									balanced = GetState(level - 1, 2 * bx + i, 2 * by + j, 2 * bz + k) != kPartial;
+								}
+							}
+						}
+						*states = balanced ? kSolid : kPartial;
+					}
+				}
+			}
+		}
+	}
+}
+
+void OctreeMesher::EmitBlock(const int level, const int bx, const int by, const int bz)
+{
+	const unsigned char state = GetState(level, bx, by, bz);
+	if (state == kEmpty)
+		return;
+
+	if (state == kSolid)
+	{
+		AddElement(bx << level, by << level, mWindowZ + (bz << level), 1 << level);
+		return;
+	}
+
+	if (level == 1)
+	{
+		// A split level 1 block is meshed voxel by voxel, as on the uniform lattice
+		for (int c = 0; c < 8; ++c)
+		{
+			const int x = 2 * bx + (c & 1);
+			const int y = 2 * by + ((c >> 1) & 1);
+			const int z = mWindowZ + 2 * bz + (c >> 2);
+			const OccupancySlice* slice = GetSlice(z);
+			if (slice && x < mWidth && y < mHeight && slice->IsSet(x, y))
+				AddElement(x, y, z, 1);
+		}
+		return;
+	}
+
+	for (int c = 0; c < 8; ++c)
+		EmitBlock(level - 1, 2 * bx + (c & 1), 2 * by + ((c >> 1) & 1), 2 * bz + (c >> 2));
+}
+
+void OctreeMesher::AddElement(const int x, const int y, const int z, const int size)
+{
+	int corners[8][3];
+	VertIdType ids[8];
+	for (int c = 0; c < 8; ++c)
+	{
+		corners[c][0] = x + size * (c & 1);
+		corners[c][1] = y + size * ((c >> 1) & 1);
+		corners[c][2] = z + size * (c >> 2);
+		ids[c] = TouchNode(corners[c][0], corners[c][1], corners[c][2]);
+	}
+	for (int n = 0; n < 8; ++n)
+		mElements.push_back(ids[kOutputOrder[n]]);
+
+	if (size == 1)
+		return;
+
+	// Any node at the middle of an edge or face of this element is a hanging node. Which of them
+	// are nodes is only known once every element that could touch them has been meshed.
+	Candidate candidate;
+	for (int e = 0; e < 12; ++e)
+	{
+		const int* a = corners[kEdges[e][0]];
+		const int* b = corners[kEdges[e][1]];
+		candidate.x = (a[0] + b[0]) / 2;
+		candidate.y = (a[1] + b[1]) / 2;
+		candidate.z = (a[2] + b[2]) / 2;
+		candidate.masters[0] = ids[kEdges[e][0]];
+		candidate.masters[1] = ids[kEdges[e][1]];
+		candidate.masters[2] = kNoConstraintNode;
+		candidate.masters[3] = kNoConstraintNode;
+		mCandidates.push_back(candidate);
+	}
+	for (int f = 0; f < 6; ++f)
+	{
+		const int* a = corners[kFaces[f][0]];
+		const int* b = corners[kFaces[f][3]];
+		candidate.x = (a[0] + b[0]) / 2;
+		candidate.y = (a[1] + b[1]) / 2;
+		candidate.z = (a[2] + b[2]) / 2;
+		for (int m = 0; m < 4; ++m)
+			candidate.masters[m] = ids[kFaces[f][m]];
+		mCandidates.push_back(candidate);
+	}
+}
+
+VertIdType OctreeMesher::TouchNode(const int x, const int y, const int z)
+{
+	const size_t slot = static_cast<size_t>(z) % mPlanes.size();
+	NodePlane& plane = mPlanes[slot];
+	if (mPlaneZ[slot] != z)
+	{
+		// The plane this slot held is out of reach of every element and candidate still to come
+		plane.Clear();
+		mPlaneZ[slot] = z;
+	}
+
+	const uint64_t key = (static_cast<uint64_t>(y) << 32) | static_cast<uint32_t>(x);
+	const NodeEntry* node = plane.Find(key);
+	if (node)
+		return node->id;
+
+	const NodeEntry entry = { GetNodeCount(), false };
+	plane.Insert(key, entry);
+	mNodes.push_back(Vec3(mSpacing * static_cast<float>(x),
+						  mSpacing * static_cast<float>(y),
+						  mSpacing * static_cast<float>(z)));
+	return entry.id;
+}
+
+OctreeMesher::NodeEntry* OctreeMesher::FindNode(const int x, const int y, const int z)
+{
+	const size_t slot = static_cast<size_t>(z) % mPlanes.size();
+	if (mPlaneZ[slot] != z)
+		return NULL;
+	return mPlanes[slot].Find((static_cast<uint64_t>(y) << 32) | static_cast<uint32_t>(x));
+}
+
+void OctreeMesher::ResolveCandidates(const std::vector<Candidate>& candidates)
+{
+	// Neighbouring elements of the same size share edge midpoints, so each node is listed once
+	for (auto candidate = candidates.begin(); candidate != candidates.end(); ++candidate)
+	{
+		NodeEntry* node = FindNode(candidate->x, candidate->y, candidate->z);
+		if (!node || node->constrained)
+			continue;
+
+		node->constrained = true;
+		mConstraints.push_back(node->id);
+		mConstraints.insert(mConstraints.end(), candidate->masters, candidate->masters + kConstraintValues - 1);
+	}
+}
+
+OctreeMesher::NodeEntry* OctreeMesher::NodePlane::Find(const uint64_t key)
+{
+	if (mSize == 0)
+		return NULL;
+	for (size_t slot = Slot(key); mKeys[slot] != kNoKey; slot = (slot + 1) & (mKeys.size() - 1))
+	{
+		if (mKeys[slot] == key)
+			return &mEntries[slot];
+	}
+	return NULL;
+}
+
+OctreeMesher::NodeEntry& OctreeMesher::NodePlane::Insert(const uint64_t key, const NodeEntry& entry)
+{
+	// At most half full, so probes stay short
+	if (2 * (mSize + 1) > mKeys.size())
+		Grow();
+
+	size_t slot = Slot(key);
+	while (mKeys[slot] != kNoKey)
+		slot = (slot + 1) & (mKeys.size() - 1);
+	mKeys[slot] = key;
+	mEntries[slot] = entry;
+	++mSize;
+	return mEntries[slot];
+}
+
+void OctreeMesher::NodePlane::Clear()
+{
+	if (mSize == 0)
+		return;
+	std::fill(mKeys.begin(), mKeys.end(), kNoKey);
+	mSize = 0;
+}
+
+void OctreeMesher::NodePlane::Grow()
+{
+	std::vector<uint64_t> keys(std::max<size_t>(2 * mKeys.size(), 1024), kNoKey);
+	std::vector<NodeEntry> entries(keys.size());
+	keys.swap(mKeys);
+	entries.swap(mEntries);
+	mSize = 0;
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		if (keys[i] != kNoKey)
+			Insert(keys[i], entries[i]);
+	}
+}
+
+// EOF
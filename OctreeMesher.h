@@ -0,0 +1,169 @@
+///  @file	OctreeMesher.h
+///  @brief	Implements class: OctreeMesher
+///
+///		Meshes a stack as a balanced octree of hexahedra for --adaptive,
+///     rather than one element per voxel. Every fully-solid, aligned block
+///     of 2^n x 2^n x 2^n voxels (n up to the max level) becomes one element,
+///     so the interior of a thick specimen costs a few large elements rather
+///     than millions of identical ones. Voxels that can't be merged are
+///     meshed as they are on the uniform lattice.
+///
+///		The octree is 2:1 balanced: elements that touch (at a face, an edge or
+///     a corner) differ in size by at most a factor of two. A block of level
+///     n >= 2 is only merged if none of the level n-1 blocks touching it will
+///     be split, which makes the balance hold by construction and keeps every
+///     decision local to within 2^n voxels of the block.
+///
+///		Nodes are lattice points and are numbered in first-touch order, with
+///     each element's corners touched in the same order as on the uniform
+///     lattice (x fastest, then y, then z), and written in the same
+///     [0,1,3,2,4,5,7,6] order. With a max level at which no block merges the
+///     elements are the same voxels, though not in the same order.
+///
+///		A node of a smaller element that lies in the middle of an edge or face
+///     of a larger one is a hanging node. GetConstraints() lists each one with
+///     the 2 (edge) or 4 (face) corners of the larger element that it is the
+///     average of. A corner can itself be a hanging node of a still larger
+///     element, so a solver should resolve constraints recursively.
+///
+///		Slices are added in stack order and meshed in slabs of 2^maxLevel
+///     slices. A slab is meshed once the slab after it has been added, as
+///     its blocks' balance depends on the slabs either side, so three slabs
+///     of slices are held at a time. Nodes are kept in a window of the node
+///     planes that later elements or constraints can still reach.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "OccupancySlice.h"
+#include "MeshFormat.h" // kConstraintValues, kNoConstraintNode
+
+class OctreeMesher
+{
+public:
+	static const int kMaxLevel = 6;     // blocks of up to 64^3 voxels
+
+	OctreeMesher(const int width, const int height, const int maxLevel);
+
+	// Nodes are placed at spacing * (x, y, z), e.g. k for a lattice coarsened k times (1 by default)
+	void SetSpacing(const float spacing) { mSpacing = spacing; }
+
+	// Adds the next slice, by slice.z. Slices that are skipped, or weren't read, are background.
+	// Meshes the slabs that the slice completes the neighbourhood of.
+	void AddSlice(const OccupancySlice& slice);
+
+	// Meshes the rest of the stack once the last slice has been added
+	void Finish();
+
+	// Elements meshed since the last ClearElements(), 8 node IDs each in output order
+	const std::vector<VertIdType>& GetElements() const { return mElements; }
+	void ClearElements() { mElements.clear(); }
+
+	uint64_t GetNodeCount() const { return mFirstPendingId + mNodes.size(); }
+	VertIdType GetFirstPendingId() const { return mFirstPendingId; }
+	const std::vector<Vec3>& GetPendingNodes() const { return mNodes; }
+	void ClearPendingNodes();
+
+	// Constraints found since the last ClearConstraints(), kConstraintValues node IDs each
+	const std::vector<VertIdType>& GetConstraints() const { return mConstraints; }
+	void ClearConstraints() { mConstraints.clear(); }
+
+protected:
+	OctreeMesher(const OctreeMesher&);              // not copyable
+	OctreeMesher& operator=(const OctreeMesher&);
+
+	enum BlockState
+	{
+		kEmpty,
+		kPartial,   // split into smaller elements
+		kSolid      // one element, or part of a larger one
+	};
+
+	struct NodeEntry
+	{
+		VertIdType id;
+		bool constrained;
+	};
+
+	// A point that is a hanging node if any element has a corner there
+	struct Candidate
+	{
+		int x, y, z;
+		VertIdType masters[kConstraintValues - 1];
+	};
+
+	// The nodes of one plane, keyed by (y << 32) | x. Open addressing with linear probing in flat arrays,
+	// as a plane gains and loses thousands of nodes per slab. Rows are scattered over the table, but
+	// the nodes of a row stay in x order, so meshing along a row walks the table in order.
+	class NodePlane
+	{
+	public:
+		NodePlane() : mSize(0) {}
+
+		NodeEntry* Find(const uint64_t key);
+		NodeEntry& Insert(const uint64_t key, const NodeEntry& entry);  // key must not be present
+		void Clear();
+
+	protected:
+		inline size_t Slot(const uint64_t key) const { return static_cast<size_t>((key >> 32) * 0x9E3779B1u + (key & 0xFFFFFFFFu)) & (mKeys.size() - 1); }
+		void Grow();
+
+		static const uint64_t kNoKey = ~0ull;
+
+		std::vector<uint64_t> mKeys;    // a power of two of slots, kNoKey if free
+		std::vector<NodeEntry> mEntries;
+		size_t mSize;
+	};
+
+	const OccupancySlice* GetSlice(const int z) const;
+	void MeshSlab();
+	void ComputeStates();
+	inline unsigned char GetState(const int level, const int bx, const int by, const int bz) const;
+	void EmitBlock(const int level, const int bx, const int by, const int bz);
+	void AddElement(const int x, const int y, const int z, const int size);
+	VertIdType TouchNode(const int x, const int y, const int z);
+	NodeEntry* FindNode(const int x, const int y, const int z);
+	void ResolveCandidates(const std::vector<Candidate>& candidates);
+
+	const int mWidth;
+	const int mHeight;
+	const int mMaxLevel;
+	const int mSlabDepth;               // 2^mMaxLevel slices
+
+	std::vector<OccupancySlice> mSlices;    // three slabs, slice z in slot z % (3 * mSlabDepth)
+	std::vector<int> mSliceZ;               // per slot: the slice it holds, or -1
+	std::vector<uint64_t> mZeroRow;         // stands in for rows of background
+	int mLastZ;                             // the last slice added
+	int mNextSlab;                          // the next slab to mesh
+
+	// Per level, the state of each block of the three slabs around the slab being meshed
+	std::vector<unsigned char> mStates[kMaxLevel + 1];
+	int mStateDims[kMaxLevel + 1][3];
+	int mWindowZ;                           // first slice of the three slabs
+
+	std::vector<VertIdType> mElements;
+	std::vector<Candidate> mCandidates;     // of the slab just meshed
+	std::vector<Candidate> mPrevCandidates; // of the slab before it
+	std::vector<VertIdType> mConstraints;
+
+	std::vector<NodePlane> mPlanes;         // node plane z in slot z % (2 * mSlabDepth + 1)
+	std::vector<int> mPlaneZ;               // per slot: the plane it holds, or -1
+	std::vector<Vec3> mNodes;               // nodes mFirstPendingId onwards
+	VertIdType mFirstPendingId;
+	float mSpacing;
+};
+
+unsigned char OctreeMesher::GetState(const int level, const int bx, const int by, const int bz) const
+{
+	const int* dims = mStateDims[level];
+	if (bx < 0 || by < 0 || bz < 0 || bx >= dims[0] || by >= dims[1] || bz >= dims[2])
+		return kEmpty;
+	return mStates[level][(static_cast<size_t>(bz) * dims[1] + by) * dims[0] + bx];
+}
@@ -0,0 +1,128 @@
+///  @file	OrderedWriter.cpp
+///  @brief	Implements class: OrderedWriter
+///
+///		Writes blocks of formatted output in queue order. See OrderedWriter.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "OrderedWriter.h"
+
+OrderedWriter::OrderedWriter(const bool threaded)
+: mStats(NULL),
+  mMaxBlocks(64),
+  mBusy(false),
+  mStopping(false)
+{
+	if (threaded)
+		mThread = std::thread(&OrderedWriter::WriterLoop, this);
+}
+
+OrderedWriter::~OrderedWriter()
+{
+	if (mThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStopping = true;
+		}
+		mQueued.notify_all();
+		mThread.join();
+	}
+}
+
+std::string OrderedWriter::AcquireBlock()
+{
+	std::unique_lock<std::mutex> lock(mMutex, std::defer_lock);
+	if (mThread.joinable())
+		lock.lock();
+
+	std::string block;
+	if (!mFreeBlocks.empty())
+	{
+		block.swap(mFreeBlocks.back());
+		mFreeBlocks.pop_back();
+	}
+	return block;
+}
+
+void OrderedWriter::Write(std::ostream& os, std::string&& block)
+{
+	if (!mThread.joinable())
+	{
+		{
+			StageTimer timer(mStats, RunStats::kWrite);
+			os.write(block.data(), block.size());
+		}
+		Recycle(std::move(block));
+		return;
+	}
+
+	{
+		StageTimer timer(mStats, RunStats::kWriteWait);
+		std::unique_lock<std::mutex> lock(mMutex);
+		mWritten.wait(lock, [this]() { return mBlocks.size() < mMaxBlocks; });
+		mBlocks.push_back(std::make_pair(&os, std::move(block)));
+	}
+	mQueued.notify_one();
+}
+
+void OrderedWriter::Flush()
+{
+	if (!mThread.joinable())
+		return;
+
+	StageTimer timer(mStats, RunStats::kWriteWait);
+	std::unique_lock<std::mutex> lock(mMutex);
+	mWritten.wait(lock, [this]() { return mBlocks.empty() && !mBusy; });
+}
+
+void OrderedWriter::Recycle(std::string&& block)
+{
+	// Enough to cover every block that can be queued, and no more
+	if (mFreeBlocks.size() < mMaxBlocks + 1)
+	{
+		block.clear();
+		mFreeBlocks.push_back(std::move(block));
+	}
+}
+
+void OrderedWriter::WriterLoop()
+{
+	bool named = false;
+	for (;;)
+	{
+		std::pair<std::ostream*, std::string> block;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mQueued.wait(lock, [this]() { return mStopping || !mBlocks.empty(); });
+			if (mBlocks.empty())
+				return; // stopping and drained
+			block = std::move(mBlocks.front());
+			mBlocks.pop_front();
+			mBusy = true;
+		}
+
+		// mStats is set before the first block is queued, so it can be read once there is one
+		if (!named && mStats && mStats->GetTracer())
+			mStats->GetTracer()->NameThread("writer");
+		named = true;
+
+		{
+			StageTimer timer(mStats, RunStats::kWrite);
+			block.first->write(block.second.data(), block.second.size());
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			Recycle(std::move(block.second));
+			mBusy = false;
+		}
+		mWritten.notify_all();
+	}
+}
+
+// EOF
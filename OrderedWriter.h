@@ -0,0 +1,61 @@
+///  @file	OrderedWriter.h
+///  @brief	Implements class: OrderedWriter
+///
+///		Writes blocks of formatted output to their streams in the order the
+///     blocks were queued. When threaded, the writes happen on a background
+///     thread so the disk stays busy while the next slice is processed. The
+///     queue is bounded, so a slow disk holds the producer back rather than
+///     letting the queued blocks grow without limit.
+///
+///		Written blocks are kept (emptied, with their capacity) and handed back
+///     by AcquireBlock(), so formatting a slice doesn't have to grow a new
+///     string from nothing.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <deque>
+#include <vector>
+#include <utility> // std::pair
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "RunStats.h"
+
+class OrderedWriter
+{
+public:
+	explicit OrderedWriter(const bool threaded);
+	~OrderedWriter();
+
+	// An empty string, with the capacity of a previously written block when there is one
+	std::string AcquireBlock();
+
+	void Write(std::ostream& os, std::string&& block);
+	void Flush();
+
+	// Times writes and back-pressure into stats (NULL for none). Call before the first Write().
+	void SetStats(RunStats* stats) { mStats = stats; }
+
+protected:
+	void WriterLoop();
+	void Recycle(std::string&& block); // with mMutex held when threaded
+
+	std::deque<std::pair<std::ostream*, std::string> > mBlocks;
+	std::vector<std::string> mFreeBlocks;
+	std::mutex mMutex;
+	std::condition_variable mQueued;   // signalled when a block is queued (or on shutdown)
+	std::condition_variable mWritten;  // signalled when a block has been written
+	RunStats* mStats;
+	size_t mMaxBlocks;
+	bool mBusy;
+	bool mStopping;
+	std::thread mThread;
+};
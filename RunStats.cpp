@@ -0,0 +1,236 @@
+///  @file	RunStats.cpp
+///  @brief	Implements class: RunStats
+///
+///		Accumulates per-stage times and writes the --stats summary. See RunStats.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "RunStats.h"
+
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define PSAPI_VERSION 2 // GetProcessMemoryInfo from kernel32, no psapi.lib
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+	const char* const kStageNames[RunStats::kNumStages] =
+	{
+		"read", "threshold", "cacheRead", "cacheWrite", "sliceWait", "coarsen", "components", "mesh", "format", "write", "writeWait", "renumber", "partition"
+	};
+
+	// Doubles as JSON numbers: enough digits to be useful, never inf or nan
+	std::string JsonNumber(const double value)
+	{
+		if (!(value == value) || value > 1e300 || value < -1e300)
+			return "0";
+		char text[32];
+		snprintf(text, sizeof(text), "%.6g", value);
+		return text;
+	}
+
+	std::string JsonString(const std::string& value)
+	{
+		std::string out = "\"";
+		for (size_t i = 0; i < value.size(); ++i)
+		{
+			const unsigned char c = static_cast<unsigned char>(value[i]);
+			if (c == '"' || c == '\\')
+			{
+				out += '\\';
+				out += static_cast<char>(c);
+			}
+			else if (c < 0x20)
+			{
+				char escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				out += escaped;
+			}
+			else
+				out += static_cast<char>(c);
+		}
+		return out + "\"";
+	}
+
+	double PerSecond(const uint64_t count, const double seconds)
+	{
+		return seconds > 0.0 ? count / seconds : 0.0;
+	}
+}
+
+RunStats::RunStats()
+: mStart(Clock::now()),
+  mTrace(NULL),
+  mThreads(1),
+  mSlices(0),
+  mVoxels(0),
+  mElements(0),
+  mNodes(0)
+{
+	for (int s = 0; s < kNumStages; ++s)
+	{
+		mNanoseconds[s] = 0;
+		mCalls[s] = 0;
+	}
+}
+
+const char* RunStats::GetStageName(const Stage stage)
+{
+	return kStageNames[stage];
+}
+
+void RunStats::AddTime(const Stage stage, const Clock::time_point& start, const Clock::time_point& end, const int slice)
+{
+	mNanoseconds[stage].fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(),
+								  std::memory_order_relaxed);
+	mCalls[stage].fetch_add(1, std::memory_order_relaxed);
+	if (mTrace)
+		mTrace->AddEvent(kStageNames[stage], start, end, slice);
+}
+
+void RunStats::SetCounts(const int threads, const uint64_t slices, const uint64_t voxels,
+						 const uint64_t elements, const uint64_t nodes)
+{
+	mThreads = threads;
+	mSlices = slices;
+	mVoxels = voxels;
+	mElements = elements;
+	mNodes = nodes;
+}
+
+void RunStats::AddNodePool(const int threshold, const int group, const uint64_t planeEntries, const uint64_t planeBytes,
+						   const uint64_t nodes, const int numPlanes)
+{
+	const NodePoolStats pool = { threshold, group, planeEntries, planeBytes, nodes, numPlanes };
+	mNodePools.push_back(pool);
+}
+
+void RunStats::AddOutputFile(const std::string& name, const uint64_t bytes)
+{
+	OutputFileStats file = { name, bytes };
+	mOutputFiles.push_back(file);
+}
+
+void RunStats::AddRenumbering(const int threshold, const int group, const MeshRenumberer::Band& before, const MeshRenumberer::Band& after)
+{
+	const RenumberingStats renumbering = { threshold, group, before, after };
+	mRenumberings.push_back(renumbering);
+}
+
+void RunStats::AddPartition(const int partition, const uint64_t elements, const uint64_t nodes, const uint64_t interfaceNodes,
+							const uint64_t firstGlobalId)
+{
+	const PartitionStats stats = { partition, elements, nodes, interfaceNodes, firstGlobalId };
+	mPartitions.push_back(stats);
+}
+
+void RunStats::WriteJson(std::ostream& os) const
+{
+	const double wallSeconds = std::chrono::duration<double>(Clock::now() - mStart).count();
+
+	os << "{\n";
+	os << "  \"wallSeconds\": " << JsonNumber(wallSeconds) << ",\n";
+	os << "  \"threads\": " << mThreads << ",\n";
+	os << "  \"slices\": " << mSlices << ",\n";
+	os << "  \"voxels\": " << mVoxels << ",\n";
+	os << "  \"elements\": " << mElements << ",\n";
+	os << "  \"nodes\": " << mNodes << ",\n";
+	os << "  \"voxelsPerSecond\": " << JsonNumber(PerSecond(mVoxels, wallSeconds)) << ",\n";
+	os << "  \"elementsPerSecond\": " << JsonNumber(PerSecond(mElements, wallSeconds)) << ",\n";
+
+	os << "  \"stages\": {\n";
+	for (int s = 0; s < kNumStages; ++s)
+	{
+		os << "    " << JsonString(kStageNames[s]) << ": { \"seconds\": " << JsonNumber(mNanoseconds[s].load() * 1e-9)
+		   << ", \"calls\": " << mCalls[s].load() << " }" << (s + 1 < kNumStages ? "," : "") << "\n";
+	}
+	os << "  },\n";
+
+	// Load is the mean fraction of a plane's node IDs that were ever used
+	os << "  \"nodePools\": [\n";
+	for (size_t i = 0; i < mNodePools.size(); ++i)
+	{
+		const NodePoolStats& pool = mNodePools[i];
+		const double capacity = static_cast<double>(pool.planeEntries) * pool.numPlanes;
+		os << "    { \"threshold\": " << pool.threshold
+		   << ", \"group\": " << pool.group
+		   << ", \"planeEntries\": " << pool.planeEntries
+		   << ", \"planeBytes\": " << pool.planeBytes
+		   << ", \"nodes\": " << pool.nodes
+		   << ", \"load\": " << JsonNumber(capacity > 0.0 ? pool.nodes / capacity : 0.0)
+		   << " }" << (i + 1 < mNodePools.size() ? "," : "") << "\n";
+	}
+	os << "  ],\n";
+
+	os << "  \"outputFiles\": [\n";
+	for (size_t i = 0; i < mOutputFiles.size(); ++i)
+	{
+		os << "    { \"name\": " << JsonString(mOutputFiles[i].name) << ", \"bytes\": " << mOutputFiles[i].bytes
+		   << " }" << (i + 1 < mOutputFiles.size() ? "," : "") << "\n";
+	}
+	os << "  ],\n";
+
+	os << "  \"renumbering\": [\n";
+	for (size_t i = 0; i < mRenumberings.size(); ++i)
+	{
+		const RenumberingStats& renumbering = mRenumberings[i];
+		os << "    { \"threshold\": " << renumbering.threshold
+		   << ", \"group\": " << renumbering.group
+		   << ", \"bandwidthBefore\": " << renumbering.before.bandwidth
+		   << ", \"bandwidthAfter\": " << renumbering.after.bandwidth
+		   << ", \"profileBefore\": " << renumbering.before.profile
+		   << ", \"profileAfter\": " << renumbering.after.profile
+		   << ", \"medianSpanBefore\": " << renumbering.before.medianSpan
+		   << ", \"medianSpanAfter\": " << renumbering.after.medianSpan
+		   << " }" << (i + 1 < mRenumberings.size() ? "," : "") << "\n";
+	}
+	os << "  ],\n";
+
+	os << "  \"partitions\": [\n";
+	for (size_t i = 0; i < mPartitions.size(); ++i)
+	{
+		const PartitionStats& partition = mPartitions[i];
+		os << "    { \"partition\": " << partition.partition
+		   << ", \"elements\": " << partition.elements
+		   << ", \"nodes\": " << partition.nodes
+		   << ", \"interfaceNodes\": " << partition.interfaceNodes
+		   << ", \"firstGlobalId\": " << partition.firstGlobalId
+		   << " }" << (i + 1 < mPartitions.size() ? "," : "") << "\n";
+	}
+	os << "  ],\n";
+
+	os << "  \"peakRssBytes\": " << GetPeakResidentBytes() << "\n";
+	os << "}\n";
+}
+
+uint64_t RunStats::GetPeakResidentBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+	return counters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	return static_cast<uint64_t>(usage.ru_maxrss);          // bytes
+#else
+	return static_cast<uint64_t>(usage.ru_maxrss) * 1024;   // kilobytes
+#endif
+#endif
+}
+
+// EOF
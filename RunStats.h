@@ -0,0 +1,164 @@
+///  @file	RunStats.h
+///  @brief	Implements classes: RunStats, StageTimer
+///
+///		Accumulates where a run spends its time, for the --stats summary.
+///
+///		Each stage of the conversion (reading and thresholding bitmaps, the
+///     occupancy cache, coarsening, meshing, formatting and writing) is timed with a
+///     StageTimer around it. Stages run on worker threads as well as the main
+///     thread, so the totals are kept in atomics and are the sum over all
+///     threads: with --threads N, read and threshold can add up to more than
+///     the wall time. The two "wait" stages are the time the main thread was
+///     blocked, on the next slice and on the writer's full queue.
+///
+///		A NULL RunStats* turns every StageTimer into a no-op, so classes take
+///     one and only pay for a clock read when stats are wanted. With a
+///     TraceRecorder attached (--trace), each timed stage is also recorded as
+///     a timeline event, tagged with its slice.
+///
+///		WriteJson() writes the summary: wall time, per-stage seconds and calls,
+///     voxel and element rates, node-pool sizes and load, bytes per output
+///     file, and peak resident memory.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "TraceRecorder.h"
+#include "MeshRenumberer.h" // MeshRenumberer::Band
+
+class RunStats
+{
+public:
+	enum Stage
+	{
+		kRead,          // MappedBitmap::Open or BMP::ReadFromFile (page-ins of mapped files land in kThreshold)
+		kThreshold,     // ThresholdKernel rows and the slice summary
+		kCacheRead,     // slices from the occupancy cache
+		kCacheWrite,    // slices to the occupancy cache
+		kSliceWait,     // main thread waiting on the next thresholded slice
+		kCoarsen,       // SliceCoarsener binning, with --coarsen
+		kComponents,    // ComponentFilter labelling (both passes), with --keep-largest or --min-component-size
+		kMesh,          // node-pool lookups and element assembly
+		kFormat,        // MeshFormat::AppendElements and AppendNodes
+		kWrite,         // stream writes of formatted blocks
+		kWriteWait,     // main thread held back by the writer's full queue, or flushing it
+		kRenumber,      // MeshRenumberer, with --renumber
+		kPartition,     // DomainPartitioner counting, bisection and interface maps, with --partitions
+		kNumStages
+	};
+
+	typedef TraceRecorder::Clock Clock;
+
+	RunStats();
+
+	static const char* GetStageName(const Stage stage);
+
+	// Also records every timed stage in trace, if not NULL. Call before anything is timed.
+	void SetTracer(TraceRecorder* trace) { mTrace = trace; }
+	TraceRecorder* GetTracer() const { return mTrace; }
+
+	void AddTime(const Stage stage, const Clock::time_point& start, const Clock::time_point& end, const int slice = -1);
+
+	void SetCounts(const int threads, const uint64_t slices, const uint64_t voxels,
+				   const uint64_t elements, const uint64_t nodes);
+	void AddNodePool(const int threshold, const int group, const uint64_t planeEntries, const uint64_t planeBytes,
+					 const uint64_t nodes, const int numPlanes);
+	void AddOutputFile(const std::string& name, const uint64_t bytes);
+	void AddRenumbering(const int threshold, const int group, const MeshRenumberer::Band& before, const MeshRenumberer::Band& after);
+	void AddPartition(const int partition, const uint64_t elements, const uint64_t nodes, const uint64_t interfaceNodes,
+					  const uint64_t firstGlobalId);
+
+	void WriteJson(std::ostream& os) const;
+
+	// The most memory the process has had resident, in bytes (0 if unknown)
+	static uint64_t GetPeakResidentBytes();
+
+protected:
+	struct NodePoolStats
+	{
+		int threshold;
+		int group;
+		uint64_t planeEntries;  // node IDs per plane
+		uint64_t planeBytes;
+		uint64_t nodes;
+		int numPlanes;          // planes the pool's nodes were spread over
+	};
+
+	struct OutputFileStats
+	{
+		std::string name;
+		uint64_t bytes;
+	};
+
+	struct RenumberingStats
+	{
+		int threshold;
+		int group;
+		MeshRenumberer::Band before;
+		MeshRenumberer::Band after;
+	};
+
+	struct PartitionStats
+	{
+		int partition;
+		uint64_t elements;
+		uint64_t nodes;
+		uint64_t interfaceNodes;
+		uint64_t firstGlobalId;     // of the nodes it owns, from 1 or 0 as in its interface map
+	};
+
+	const Clock::time_point mStart;
+	TraceRecorder* mTrace;
+	std::atomic<int64_t> mNanoseconds[kNumStages];
+	std::atomic<uint64_t> mCalls[kNumStages];
+
+	int mThreads;
+	uint64_t mSlices;
+	uint64_t mVoxels;
+	uint64_t mElements;
+	uint64_t mNodes;
+	std::vector<NodePoolStats> mNodePools;
+	std::vector<OutputFileStats> mOutputFiles;
+	std::vector<RenumberingStats> mRenumberings;
+	std::vector<PartitionStats> mPartitions;
+};
+
+// Adds the time from construction to destruction to a stage, if stats is not NULL
+class StageTimer
+{
+public:
+	StageTimer(RunStats* stats, const RunStats::Stage stage, const int slice = -1)
+	: mStats(stats),
+	  mStage(stage),
+	  mSlice(slice)
+	{
+		if (mStats)
+			mStart = RunStats::Clock::now();
+	}
+
+	~StageTimer()
+	{
+		if (mStats)
+			mStats->AddTime(mStage, mStart, RunStats::Clock::now(), mSlice);
+	}
+
+protected:
+	StageTimer(const StageTimer&);            // not copyable
+	StageTimer& operator=(const StageTimer&);
+
+	RunStats* const mStats;
+	const RunStats::Stage mStage;
+	const int mSlice;
+	RunStats::Clock::time_point mStart;
+};
@@ -0,0 +1,115 @@
+///  @file	SliceCoarsener.cpp
+///  @brief	Implements class: SliceCoarsener
+///
+///		Bins a stack k x k x k voxels at a time. See SliceCoarsener.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "SliceCoarsener.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace
+{
+	// Set bits of row in [begin, end), a word at a time
+	int CountBits(const uint64_t* row, const int begin, const int end)
+	{
+		int w = begin >> 6;
+		const int lastWord = (end - 1) >> 6;
+		uint64_t word = row[w] & (~0ull << (begin & 63));
+		int count = 0;
+		while (w < lastWord)
+		{
+			count += PopCount(word);
+			word = row[++w];
+		}
+		if (end & 63)
+			word &= (1ull << (end & 63)) - 1;
+		return count + PopCount(word);
+	}
+}
+
+SliceCoarsener::SliceCoarsener(const int fineWidth, const int fineHeight, const int factor, const double fraction)
+: mFineWidth(fineWidth),
+  mFineHeight(fineHeight),
+  mFactor(factor),
+  mFraction(fraction),
+  mWidth((fineWidth + factor - 1) / factor),
+  mHeight((fineHeight + factor - 1) / factor),
+  mCounts(static_cast<size_t>(mWidth) * mHeight, 0),
+  mNumSlices(0),
+  mMinRow(INT_MAX),
+  mMaxRow(-1)
+{
+}
+
+void SliceCoarsener::Add(const OccupancySlice& fine)
+{
+	++mNumSlices;
+	if (fine.status != OccupancySlice::kOk || fine.IsEmpty())
+		return;
+
+	int minX, minY, maxX, maxY;
+	fine.GetBounds(minX, minY, maxX, maxY);
+	mMinRow = std::min(mMinRow, minY / mFactor);
+	mMaxRow = std::max(mMaxRow, maxY / mFactor);
+	for (int y = minY; y <= maxY; ++y)
+	{
+		if (fine.IsTileRowEmpty(y / OccupancySlice::kTileSize))
+		{
+			y = (y / OccupancySlice::kTileSize + 1) * OccupancySlice::kTileSize - 1;
+			continue;
+		}
+
+		const int begin = 64 * fine.GetRowFirstWord(y);
+		const int end = std::min(64 * fine.GetRowEndWord(y), mFineWidth);
+		if (begin >= end)
+			continue;
+
+		const uint64_t* row = fine.GetRow(y);
+		uint32_t* counts = &mCounts[static_cast<size_t>(y / mFactor) * mWidth];
+		for (int cx = begin / mFactor; cx * mFactor < end; ++cx)
+		{
+			const int x0 = std::max(cx * mFactor, begin);
+			const int x1 = std::min(cx * mFactor + mFactor, end);
+			counts[cx] += CountBits(row, x0, x1);
+		}
+	}
+}
+
+void SliceCoarsener::Finish(const int z, OccupancySlice& coarse)
+{
+	coarse.z = z;
+	coarse.status = OccupancySlice::kOk;
+	coarse.Resize(mWidth, mHeight);
+
+	for (int cy = mMinRow; cy <= mMaxRow; ++cy)
+	{
+		const int binHeight = std::min(mFactor, mFineHeight - cy * mFactor);
+		uint32_t* counts = &mCounts[static_cast<size_t>(cy) * mWidth];
+		uint64_t* row = coarse.GetRow(cy);
+		for (int cx = 0; cx < mWidth; ++cx)
+		{
+			if (counts[cx] == 0)
+				continue;
+
+			const int binWidth = std::min(mFactor, mFineWidth - cx * mFactor);
+			const double volume = static_cast<double>(binWidth) * binHeight * mNumSlices;
+			if (counts[cx] > mFraction * volume)
+				row[cx >> 6] |= 1ull << (cx & 63);
+			counts[cx] = 0;
+		}
+	}
+	coarse.UpdateSummary();
+
+	mNumSlices = 0;
+	mMinRow = INT_MAX;
+	mMaxRow = -1;
+}
+
+// EOF
@@ -0,0 +1,62 @@
+///  @file	SliceCoarsener.h
+///  @brief	Implements class: SliceCoarsener
+///
+///		Bins a stack k x k x k voxels at a time for --coarsen, so a coarser
+///     lattice of the same specimen comes from the same thresholding as the
+///     full-resolution one.
+///
+///		The k fine slices of a coarse slice are added one at a time as they
+///     are read. Add() counts the foreground voxels of each bin, a 64-bit
+///     word (64 voxels) per popcount, and only over the rows and words that
+///     the fine slice's summary says hold foreground. Finish() then makes the
+///     coarse slice: a bin is foreground if more than the given fraction of
+///     its voxels are (0.5 is a strict majority). Bins at the right, bottom
+///     and back of a stack whose size isn't a multiple of k are partial, and
+///     are judged on the voxels they have. Only one coarse slice of counts
+///     is held, so memory doesn't grow with k.
+///
+///		Coarse voxel (x, y, z) is fine voxels k*x to k*x + k - 1 (and so on
+///     for y and z).
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "OccupancySlice.h"
+
+class SliceCoarsener
+{
+public:
+	SliceCoarsener(const int fineWidth, const int fineHeight, const int factor, const double fraction);
+
+	int GetWidth() const { return mWidth; }
+	int GetHeight() const { return mHeight; }
+
+	// Counts one fine slice into the current coarse slice. Slices that weren't read count as background.
+	void Add(const OccupancySlice& fine);
+
+	// Makes coarse slice z from the fine slices added since the last call, and starts the next one
+	void Finish(const int z, OccupancySlice& coarse);
+
+protected:
+	SliceCoarsener(const SliceCoarsener&);            // not copyable
+	SliceCoarsener& operator=(const SliceCoarsener&);
+
+	const int mFineWidth;
+	const int mFineHeight;
+	const int mFactor;
+	const double mFraction;
+	const int mWidth;
+	const int mHeight;
+
+	std::vector<uint32_t> mCounts;  // foreground voxels per bin of the current coarse slice
+	int mNumSlices;                 // fine slices added to the current coarse slice
+	int mMinRow;                    // coarse rows with any count
+	int mMaxRow;
+};
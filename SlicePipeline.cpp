@@ -0,0 +1,175 @@
+///  @file	SlicePipeline.cpp
+///  @brief	Implements class: SlicePipeline
+///
+///		Reads and thresholds the bitmaps of a stack. See SlicePipeline.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "SlicePipeline.h"
+#include "MappedBitmap.h"
+
+SlicePipeline::SlicePipeline(const std::vector<std::string>& filenames,
+							 const int width, const int height,
+							 const std::vector<short>& thresholds, const bool negate,
+							 const int numThreads)
+: mFilenames(filenames),
+  mWidth(width),
+  mHeight(height),
+  mStats(NULL),
+  mNextToSubmit(0),
+  mNextToReturn(0),
+  mDepth(0)
+{
+	for (auto threshold = thresholds.begin(); threshold != thresholds.end(); ++threshold)
+		mKernels.push_back(ThresholdKernel(*threshold, negate));
+
+	if (numThreads > 1)
+	{
+		// Keep every worker busy and one more slice queued behind each of them
+		mPool.reset(new ThreadPool(numThreads));
+		mDepth = 2 * static_cast<size_t>(numThreads);
+	}
+}
+
+bool SlicePipeline::Next(OccupancySlice& slice)
+{
+	if (!Next(mFirstOnly))
+		return false;
+	std::swap(slice, mFirstOnly[0]);
+	return true;
+}
+
+bool SlicePipeline::Next(std::vector<OccupancySlice>& slices)
+{
+	if (mNextToReturn >= mFilenames.size())
+		return false;
+
+	if (!mPool)
+	{
+		DecodeSlice(static_cast<int>(mNextToReturn++), slices);
+		return true;
+	}
+
+	Prefetch();
+	std::shared_ptr<SliceSet> decoded = mInFlight.front().get();
+	mInFlight.pop_front();
+	++mNextToReturn;
+	Prefetch();
+
+	// Hand the caller's previous buffers back for a later slice, so steady state allocates nothing
+	std::swap(slices, *decoded);
+	mFree.push_back(decoded);
+	return true;
+}
+
+void SlicePipeline::Seek(const int z)
+{
+	mNextToSubmit = mNextToReturn = static_cast<size_t>(z);
+}
+
+void SlicePipeline::Prefetch()
+{
+	while (mInFlight.size() < mDepth && mNextToSubmit < mFilenames.size())
+	{
+		const int z = static_cast<int>(mNextToSubmit++);
+		std::shared_ptr<SliceSet> slices;
+		if (mFree.empty())
+			slices.reset(new SliceSet);
+		else
+		{
+			slices = mFree.back();
+			mFree.pop_back();
+		}
+		mInFlight.push_back(mPool->Submit([this, z, slices]() {
+			if (mStats && mStats->GetTracer())
+				mStats->GetTracer()->NameThread("slice worker");
+			DecodeSlice(z, *slices);
+			return slices;
+		}));
+	}
+}
+
+void SlicePipeline::DecodeSlice(const int z, SliceSet& slices) const
+{
+	const size_t numKernels = mKernels.size();
+	slices.resize(numKernels);
+	auto setStatus = [&](const OccupancySlice::Status status) {
+		for (size_t k = 0; k < numKernels; ++k)
+		{
+			slices[k].z = z;
+			slices[k].status = status;
+		}
+	};
+	setStatus(OccupancySlice::kOk);
+
+	// Uncompressed 8, 24 and 32-bit bitmaps are thresholded straight from the mapped file
+	MappedBitmap mapped;
+	bool opened;
+	{
+		StageTimer timer(mStats, RunStats::kRead, z);
+		opened = mapped.Open(mFilenames[z].c_str());
+	}
+	if (opened)
+	{
+		if (mapped.GetWidth() != mWidth || mapped.GetHeight() != mHeight)
+		{
+			setStatus(OccupancySlice::kSizeMismatch);
+			return;
+		}
+
+		// Each slice may have its own colour table, so threshold with copies of the kernels
+		std::vector<ThresholdKernel> kernels(mKernels);
+		if (mapped.GetBitDepth() == 8)
+			for (size_t k = 0; k < numKernels; ++k)
+				kernels[k].SetColorTable(mapped.GetColorTable());
+
+		StageTimer timer(mStats, RunStats::kThreshold, z);
+		for (size_t k = 0; k < numKernels; ++k)
+			slices[k].Resize(mWidth, mHeight);
+		for (int y = 0; y < mHeight; ++y)
+		{
+			const ebmpBYTE* row = mapped.GetRow(y);
+			for (size_t k = 0; k < numKernels; ++k)
+				kernels[k].ThresholdRow(row, mWidth, mapped.GetBitDepth(), slices[k].GetRow(y));
+		}
+		for (size_t k = 0; k < numKernels; ++k)
+			slices[k].UpdateSummary();
+		return;
+	}
+
+	BMP bmp;
+	bool read;
+	{
+		StageTimer timer(mStats, RunStats::kRead, z);
+		read = bmp.ReadFromFile(mFilenames[z].c_str());
+	}
+	if (!read)
+	{
+		setStatus(OccupancySlice::kReadError);
+		return;
+	}
+
+	if (bmp.TellWidth() != mWidth || bmp.TellHeight() != mHeight)
+	{
+		setStatus(OccupancySlice::kSizeMismatch);
+		return;
+	}
+
+	StageTimer timer(mStats, RunStats::kThreshold, z);
+	for (size_t k = 0; k < numKernels; ++k)
+		slices[k].Resize(mWidth, mHeight);
+	for (int y = 0; y < mHeight; ++y)
+	{
+		const RGBApixel* row = bmp.Row(y);
+		for (size_t k = 0; k < numKernels; ++k)
+			mKernels[k].ThresholdRow(row, mWidth, slices[k].GetRow(y));
+	}
+	for (size_t k = 0; k < numKernels; ++k)
+		slices[k].UpdateSummary();
+}
+
+// EOF
@@ -0,0 +1,77 @@
+///  @file	SlicePipeline.h
+///  @brief	Implements class: SlicePipeline
+///
+///		Reads and thresholds the bitmaps of a stack, handing back one
+///     OccupancySlice per bitmap in stack order.
+///
+///		A sweep of several thresholds shares one decode: each row of a bitmap
+///     is thresholded with every kernel while it is in cache, and Next()
+///     hands back one OccupancySlice per threshold. Reading the stack costs
+///     the same as for a single threshold.
+///
+///		With more than one thread, slices are decoded and thresholded on a
+///     ThreadPool up to a fixed depth ahead of the consumer. Next() always
+///     returns slices in stack order, so node numbering and element ordering
+///     in the (single) consumer are the same as for a serial run.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <future>
+#include <memory>
+#include "SliceSource.h"
+#include "ThreadPool.h"
+#include "Threshold.h"
+#include "RunStats.h"
+
+class SlicePipeline : public SliceSource
+{
+public:
+	SlicePipeline(const std::vector<std::string>& filenames,
+				  const int width, const int height,
+				  const std::vector<short>& thresholds, const bool negate,
+				  const int numThreads);
+
+	// The slice of the first threshold
+	virtual bool Next(OccupancySlice& slice);
+	virtual void Seek(const int z);
+
+	// Fills slices with the next slice of the stack, one per threshold, in the order they were given
+	bool Next(std::vector<OccupancySlice>& slices);
+
+	size_t GetNumThresholds() const { return mKernels.size(); }
+
+	const std::string& GetFilename(const int z) const { return mFilenames[z]; }
+
+	// Times reading and thresholding into stats (NULL for none). Call before the first Next().
+	void SetStats(RunStats* stats) { mStats = stats; }
+
+protected:
+	typedef std::vector<OccupancySlice> SliceSet;   // one slice per threshold
+
+	void DecodeSlice(const int z, SliceSet& slices) const;
+	void Prefetch();
+
+	const std::vector<std::string> mFilenames;
+	const int   mWidth;
+	const int   mHeight;
+	std::vector<ThresholdKernel> mKernels;
+	RunStats* mStats;
+
+	std::deque<std::future<std::shared_ptr<SliceSet> > > mInFlight;
+	std::vector<std::shared_ptr<SliceSet> > mFree;   // decoded slices the consumer has finished with
+	SliceSet mFirstOnly;                            // for Next(OccupancySlice&)
+	size_t mNextToSubmit;
+	size_t mNextToReturn;
+	size_t mDepth;      // max slices in flight
+
+	std::unique_ptr<ThreadPool> mPool; // declared last so workers stop before the members they use go away
+};
@@ -0,0 +1,28 @@
+///  @file	SliceSource.h
+///  @brief	Implements class: SliceSource
+///
+///		Something that hands back the OccupancySlices of a stack one at a
+///     time, in stack order: either SlicePipeline (decoding bitmaps) or
+///     OccupancyCacheReader (reading a cached occupancy volume).
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include "OccupancySlice.h"
+
+class SliceSource
+{
+public:
+	virtual ~SliceSource() {}
+
+	// Fills slice with the next slice of the stack. Returns false once every slice has been returned.
+	virtual bool Next(OccupancySlice& slice) = 0;
+
+	// Starts the stack at slice z instead of 0, as when resuming a run. Call before the first Next().
+	virtual void Seek(const int z) = 0;
+};
@@ -0,0 +1,197 @@
+///  @file	SurfaceMesher.cpp
+///  @brief	Implements class: SurfaceMesher
+///
+///		Meshes the boundary faces of the voxel set. See SurfaceMesher.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "SurfaceMesher.h"
+
+#include <algorithm>
+#include <climits>
+
+SurfaceMesher::SurfaceMesher(const int x0, const int y0, const int width, const int height, const bool triangles)
+: mPool(x0, y0, width, height),
+  mTriangles(triangles),
+  mHasPrev(false),
+  mSliceZ(0)
+{
+}
+
+void SurfaceMesher::AddSlice(const OccupancySlice& slice)
+{
+	if (slice.status != OccupancySlice::kOk || slice.IsEmpty())
+		return;
+
+	if (mHasPrev && mPrev.z == slice.z - 1)
+	{
+		BeginSlice(slice.z);
+		AddCapFaces(&mPrev, &slice);
+	}
+	else
+	{
+		// Background in between, so the previous slice is closed on top and this one underneath
+		if (mHasPrev)
+			AddCapFaces(&mPrev, NULL);
+		BeginSlice(slice.z);
+		AddCapFaces(NULL, &slice);
+	}
+
+	AddSideFaces(slice);
+	mPrev = slice;
+	mHasPrev = true;
+}
+
+void SurfaceMesher::Finish()
+{
+	if (mHasPrev)
+		AddCapFaces(&mPrev, NULL);
+	mHasPrev = false;
+}
+
+void SurfaceMesher::BeginSlice(const int z)
+{
+	mPool.BeginSlice(z);
+	mSliceZ = z;
+}
+
+void SurfaceMesher::AddCapFaces(const OccupancySlice* below, const OccupancySlice* above)
+{
+	const int z = below ? below->z + 1 : above->z;
+
+	// Only the rows that either side has foreground in
+	int minY = INT_MAX;
+	int maxY = -1;
+	for (int side = 0; side < 2; ++side)
+	{
+		const OccupancySlice* slice = side ? above : below;
+		int minX, sliceMinY, maxX, sliceMaxY;
+		if (!slice)
+			continue;
+		slice->GetBounds(minX, sliceMinY, maxX, sliceMaxY);
+		minY = std::min(minY, sliceMinY);
+		maxY = std::max(maxY, sliceMaxY);
+	}
+
+	for (int y = minY; y <= maxY; ++y)
+	{
+		// The words of the row that either side has foreground in
+		int firstWord = INT_MAX;
+		int endWord = 0;
+		const uint64_t* rowBelow = NULL;
+		const uint64_t* rowAbove = NULL;
+		if (below && below->GetRowFirstWord(y) < below->GetRowEndWord(y))
+		{
+			rowBelow = below->GetRow(y);
+			firstWord = below->GetRowFirstWord(y);
+			endWord = below->GetRowEndWord(y);
+		}
+		if (above && above->GetRowFirstWord(y) < above->GetRowEndWord(y))
+		{
+			rowAbove = above->GetRow(y);
+			firstWord = std::min(firstWord, above->GetRowFirstWord(y));
+			endWord = std::max(endWord, above->GetRowEndWord(y));
+		}
+
+		for (int w = firstWord; w < endWord; ++w)
+		{
+			const uint64_t b = rowBelow ? rowBelow[w] : 0;
+			const uint64_t a = rowAbove ? rowAbove[w] : 0;
+			for (uint64_t bits = a ^ b; bits != 0; bits &= bits - 1)
+			{
+				const int x = 64 * w + CountTrailingZeros(bits);
+				if ((b >> (x & 63)) & 1)
+				{
+					const int corners[4][3] = { { x, y, z }, { x + 1, y, z }, { x + 1, y + 1, z }, { x, y + 1, z } };
+					AddFace(corners);
+				}
+				else
+				{
+					const int corners[4][3] = { { x, y, z }, { x, y + 1, z }, { x + 1, y + 1, z }, { x + 1, y, z } };
+					AddFace(corners);
+				}
+			}
+		}
+	}
+}
+
+void SurfaceMesher::AddSideFaces(const OccupancySlice& slice)
+{
+	const int z = slice.z;
+	const int wordsPerRow = slice.GetWordsPerRow();
+	int minX, minY, maxX, maxY;
+	slice.GetBounds(minX, minY, maxX, maxY);
+
+	for (int y = minY; y <= maxY; ++y)
+	{
+		const int firstWord = slice.GetRowFirstWord(y);
+		const int endWord = slice.GetRowEndWord(y);
+		if (firstWord >= endWord)
+			continue;
+
+		const uint64_t* row = slice.GetRow(y);
+		const uint64_t* rowBefore = (y > 0) ? slice.GetRow(y - 1) : NULL;
+		const uint64_t* rowAfter = (y + 1 < slice.GetHeight()) ? slice.GetRow(y + 1) : NULL;
+		for (int w = firstWord; w < endWord; ++w)
+		{
+			const uint64_t r = row[w];
+			if (r == 0)
+				continue;
+
+			// Neighbours of each voxel along x, carried across word boundaries
+			const uint64_t left = (r << 1) | ((w > 0) ? (row[w - 1] >> 63) : 0);
+			const uint64_t right = (r >> 1) | ((w + 1 < wordsPerRow) ? (row[w + 1] << 63) : 0);
+
+			const uint64_t minusY = r & ~(rowBefore ? rowBefore[w] : 0);
+			const uint64_t plusY = r & ~(rowAfter ? rowAfter[w] : 0);
+			const uint64_t minusX = r & ~left;
+			const uint64_t plusX = r & ~right;
+
+			for (uint64_t bits = minusY; bits != 0; bits &= bits - 1)
+			{
+				const int x = 64 * w + CountTrailingZeros(bits);
+				const int corners[4][3] = { { x, y, z }, { x + 1, y, z }, { x + 1, y, z + 1 }, { x, y, z + 1 } };
+				AddFace(corners);
+			}
+			for (uint64_t bits = plusY; bits != 0; bits &= bits - 1)
+			{
+				const int x = 64 * w + CountTrailingZeros(bits);
+				const int corners[4][3] = { { x, y + 1, z }, { x, y + 1, z + 1 }, { x + 1, y + 1, z + 1 }, { x + 1, y + 1, z } };
+				AddFace(corners);
+			}
+			for (uint64_t bits = minusX; bits != 0; bits &= bits - 1)
+			{
+				const int x = 64 * w + CountTrailingZeros(bits);
+				const int corners[4][3] = { { x, y, z }, { x, y, z + 1 }, { x, y + 1, z + 1 }, { x, y + 1, z } };
+				AddFace(corners);
+			}
+			for (uint64_t bits = plusX; bits != 0; bits &= bits - 1)
+			{
+				const int x = 64 * w + CountTrailingZeros(bits) + 1;
+				const int corners[4][3] = { { x, y, z }, { x, y + 1, z }, { x, y + 1, z + 1 }, { x, y, z + 1 } };
+				AddFace(corners);
+			}
+		}
+	}
+}
+
+void SurfaceMesher::AddFace(const int corners[4][3])
+{
+	VertIdType ids[4];
+	for (int c = 0; c < 4; ++c)
+		ids[c] = mPool.AddNodeRef(corners[c][0], corners[c][1], corners[c][2] - mSliceZ);
+
+	if (mTriangles)
+	{
+		const VertIdType triangles[6] = { ids[0], ids[1], ids[2], ids[0], ids[2], ids[3] };
+		mFaces.insert(mFaces.end(), triangles, triangles + 6);
+	}
+	else
+		mFaces.insert(mFaces.end(), ids, ids + 4);
+}
+
+// EOF
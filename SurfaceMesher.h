@@ -0,0 +1,76 @@
+///  @file	SurfaceMesher.h
+///  @brief	Implements class: SurfaceMesher
+///
+///		Meshes only the boundary of the voxel set for --surface: every face
+///     between a foreground voxel and a background one (or the outside of
+///     the stack) becomes a quad, or two triangles. Faces are wound counter-
+///     clockwise seen from outside, so their normals point out of the solid.
+///
+///		Slices are added in stack order. The faces between slices z-1 and z
+///     need both, so the previous slice is kept, and the faces of a slice
+///     only touch node planes z and z+1. Nodes are pooled in a
+///     LatticeNodePool, which keeps just those two planes, so memory is
+///     about a slice whatever the depth of the stack. Only nodes on the
+///     surface get IDs, in first-touch order, so the numbering is compact.
+///
+///		Per slice the faces are: those below it (against the slice before),
+///     then per row those on the -y, +y, -x and +x sides of its voxels.
+///     Faces are found a 64-bit word (64 voxels) at a time.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <vector>
+#include "OccupancySlice.h"
+#include "LatticeNodePool.h"
+
+class SurfaceMesher
+{
+public:
+	// Meshes the voxels (x0, y0) to (x0 + width - 1, y0 + height - 1) of each slice, as 4 node quads or 3 node triangles
+	SurfaceMesher(const int x0, const int y0, const int width, const int height, const bool triangles);
+
+	void SetSpacing(const float spacing) { mPool.SetSpacing(spacing); }
+
+	// Adds the next slice, by slice.z. Slices that are skipped, or weren't read, are background.
+	void AddSlice(const OccupancySlice& slice);
+
+	// Closes the surface above the last slice added
+	void Finish();
+
+	int GetNodesPerFace() const { return mTriangles ? 3 : 4; }
+
+	// Faces meshed since the last ClearElements(), GetNodesPerFace() node IDs each
+	const std::vector<VertIdType>& GetElements() const { return mFaces; }
+	void ClearElements() { mFaces.clear(); }
+
+	uint64_t GetNodeCount() const { return mPool.GetNodeCount(); }
+	VertIdType GetFirstPendingId() const { return mPool.GetFirstPendingId(); }
+	const std::vector<Vec3>& GetPendingNodes() const { return mPool.GetPendingNodes(); }
+	void ClearPendingNodes() { mPool.ClearPendingNodes(); }
+
+protected:
+	SurfaceMesher(const SurfaceMesher&);            // not copyable
+	SurfaceMesher& operator=(const SurfaceMesher&);
+
+	void BeginSlice(const int z);
+
+	// The faces between below and above (either may be NULL, for background), facing away from the foreground
+	void AddCapFaces(const OccupancySlice* below, const OccupancySlice* above);
+	void AddSideFaces(const OccupancySlice& slice);
+
+	// corners are lattice points on planes mSliceZ and mSliceZ + 1, in winding order
+	void AddFace(const int corners[4][3]);
+
+	LatticeNodePool mPool;
+	const bool mTriangles;
+	OccupancySlice mPrev;       // the last slice added
+	bool mHasPrev;
+	int mSliceZ;                // the slice the pool is on
+	std::vector<VertIdType> mFaces;
+};
@@ -0,0 +1,82 @@
+///  @file	TextFormat.cpp
+///  @brief	Fast number formatting for the ascii output
+///
+///		See TextFormat.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "TextFormat.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	// "00" "01" ... "99"
+	struct DigitPairs
+	{
+		DigitPairs()
+		{
+			for (int i = 0; i < 100; ++i)
+			{
+				pairs[2 * i]     = static_cast<char>('0' + i / 10);
+				pairs[2 * i + 1] = static_cast<char>('0' + i % 10);
+			}
+		}
+		char pairs[200];
+	};
+	const DigitPairs kDigits;
+
+	inline int CountDigits(const uint64_t value)
+	{
+		int digits = 1;
+		for (uint64_t v = value; v >= 10; v /= 10)
+			++digits;
+		return digits;
+	}
+}
+
+char* FormatUInt(char* out, uint64_t value)
+{
+	char* end = out + CountDigits(value);
+	char* p = end;
+	while (value >= 100)
+	{
+		const unsigned int pair = static_cast<unsigned int>(value % 100);
+		value /= 100;
+		p -= 2;
+		memcpy(p, &kDigits.pairs[2 * pair], 2);
+	}
+	if (value >= 10)
+	{
+		p -= 2;
+		memcpy(p, &kDigits.pairs[2 * value], 2);
+	}
+	else
+		*--p = static_cast<char>('0' + value);
+	return end;
+}
+
+char* FormatFloat(char* out, const float value)
+{
+	// Lattice coordinates are whole numbers. "%g" prints whole numbers below 10^6 as plain integers.
+	const float magnitude = std::fabs(value);
+	if (magnitude < 1e6f && magnitude == std::floor(magnitude))
+	{
+		if (std::signbit(value))
+			*out++ = '-';
+		return FormatUInt(out, static_cast<uint64_t>(magnitude));
+	}
+
+	char text[32];
+	const int length = snprintf(text, sizeof(text), "%g", static_cast<double>(value));
+	memcpy(out, text, length);
+	return out + length;
+}
+
+// EOF
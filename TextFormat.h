@@ -0,0 +1,27 @@
+///  @file	TextFormat.h
+///  @brief	Fast number formatting for the ascii output
+///
+///		FormatUInt() and FormatFloat() write straight into a char buffer
+///     without going through iostream and its locale. FormatFloat() gives
+///     the same text as std::ostream << float with the default stream
+///     settings (printf "%g").
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+const size_t kMaxUIntChars  = 20;   // 18446744073709551615
+const size_t kMaxFloatChars = 16;   // -1.17549e-38
+
+// Writes the decimal digits of value at out. Returns one past the last character written.
+char* FormatUInt(char* out, uint64_t value);
+
+// Writes value as "%g" would. Returns one past the last character written.
+char* FormatFloat(char* out, const float value);
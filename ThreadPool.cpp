@@ -0,0 +1,49 @@
+///  @file	ThreadPool.cpp
+///  @brief	Implements class: ThreadPool
+///
+///		A fixed-size pool of worker threads. See ThreadPool.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(const int numThreads)
+: mStopping(false)
+{
+	for (int i = 0; i < numThreads; ++i)
+		mThreads.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mCond.notify_all();
+	for (auto t = mThreads.begin(); t != mThreads.end(); ++t)
+		t->join();
+}
+
+void ThreadPool::WorkerLoop()
+{
+	for (;;)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mCond.wait(lock, [this]() { return mStopping || !mTasks.empty(); });
+			if (mTasks.empty())
+				return; // stopping and drained
+			task = std::move(mTasks.front());
+			mTasks.pop_front();
+		}
+		task();
+	}
+}
+
+// EOF
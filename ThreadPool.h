@@ -0,0 +1,61 @@
+///  @file	ThreadPool.h
+///  @brief	Implements class: ThreadPool
+///
+///		A fixed-size pool of worker threads. Submit() queues a task and returns
+///     a std::future for its result, so the caller can consume results in the
+///     order it submitted them regardless of which worker finishes first.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+
+class ThreadPool
+{
+public:
+	explicit ThreadPool(const int numThreads);
+	~ThreadPool();
+
+	template<class F>
+	std::future<typename std::result_of<F()>::type> Submit(F task);
+
+	int GetThreadCount() const { return static_cast<int>(mThreads.size()); }
+
+protected:
+	void WorkerLoop();
+
+	std::vector<std::thread> mThreads;
+	std::deque<std::function<void()> > mTasks;
+	std::mutex mMutex;
+	std::condition_variable mCond;
+	bool mStopping;
+};
+
+template<class F>
+std::future<typename std::result_of<F()>::type> ThreadPool::Submit(F task)
+{
+	typedef typename std::result_of<F()>::type ResultType;
+
+	// std::function must be copyable, so the (move-only) packaged_task is shared
+	std::shared_ptr<std::packaged_task<ResultType()> > packaged(new std::packaged_task<ResultType()>(task));
+	std::future<ResultType> result = packaged->get_future();
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mTasks.push_back([packaged]() { (*packaged)(); });
+	}
+	mCond.notify_one();
+	return result;
+}
@@ -0,0 +1,320 @@
+///  @file	Threshold.cpp
+///  @brief	Gray-level thresholding of bitmap pixels
+///
+///		Scalar, SSE2/SSSE3 and AVX2 row kernels for ThresholdKernel. See
+///     Threshold.h.
+///
+///		Every kernel compares the sum R+G+B instead of dividing by 3:
+///     (R+G+B)/3 > t  is  R+G+B > 3t+2,  and  (R+G+B)/3 < t  is  R+G+B < 3t.
+///     Sums are at most 765, so they fit in 16-bit lanes.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "Threshold.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BMP2VOX_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define BMP2VOX_TARGET(x)
+#else
+#define BMP2VOX_TARGET(x) __attribute__((target(x)))
+#endif
+#endif
+
+namespace
+{
+	inline int Clamp(const int v, const int lo, const int hi)
+	{
+		return std::min(std::max(v, lo), hi);
+	}
+
+	// *** Scalar kernels. These handle the partial word at the end of a row for the SIMD paths too.
+
+	uint64_t Word8Scalar(const ebmpBYTE* p, const int n, const unsigned char* lut)
+	{
+		uint64_t word = 0;
+		for (int i = 0; i < n; ++i)
+			word |= static_cast<uint64_t>(lut[p[i]]) << i;
+		return word;
+	}
+
+	uint64_t WordRGBScalar(const ebmpBYTE* p, const int n, const int bytesPerPixel, const int above, const int below)
+	{
+		uint64_t word = 0;
+		for (int i = 0; i < n; ++i, p += bytesPerPixel)
+		{
+			const int sum = p[0] + p[1] + p[2];
+			word |= static_cast<uint64_t>((sum > above) | (sum < below)) << i;
+		}
+		return word;
+	}
+
+#ifdef BMP2VOX_X86
+	// *** SSE2 / SSSE3 kernels, 16 pixels per step
+
+	// Gray-ramp 8-bit: foreground if index > above or index < below. In unsigned bytes that is
+	// max(x, above+1) == x and min(x, below-1) == x, with above == 255 / below == 0 meaning never.
+	BMP2VOX_TARGET("sse2")
+	uint64_t Word8SSE2(const ebmpBYTE* p, const int above, const int below)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i aboveV = _mm_set1_epi8(static_cast<char>(above + 1));
+		const __m128i belowV = _mm_set1_epi8(static_cast<char>(below - 1));
+		uint64_t word = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+			const __m128i gt = (above < 255) ? _mm_cmpeq_epi8(_mm_max_epu8(x, aboveV), x) : zero;
+			const __m128i lt = (below > 0) ? _mm_cmpeq_epi8(_mm_min_epu8(x, belowV), x) : zero;
+			word |= static_cast<uint64_t>(static_cast<unsigned int>(_mm_movemask_epi8(_mm_or_si128(gt, lt)))) << (16 * i);
+		}
+		return word;
+	}
+
+	// Sum B+G+R of four BGRA pixels into four 32-bit lanes
+	BMP2VOX_TARGET("sse2")
+	inline __m128i SumBGRA4(const ebmpBYTE* p)
+	{
+		const __m128i x = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), _mm_set1_epi32(0x00FFFFFF));
+		const __m128i s16 = _mm_add_epi16(_mm_and_si128(x, _mm_set1_epi32(0x00FF00FF)), _mm_srli_epi16(x, 8)); // (B+G, R)
+		return _mm_add_epi32(_mm_and_si128(s16, _mm_set1_epi32(0xFFFF)), _mm_srli_epi32(s16, 16));
+	}
+
+	BMP2VOX_TARGET("sse2")
+	inline unsigned int Mask16SSE2(const __m128i sumLo, const __m128i sumHi, const __m128i aboveV, const __m128i belowV)
+	{
+		const __m128i lo = _mm_or_si128(_mm_cmpgt_epi16(sumLo, aboveV), _mm_cmplt_epi16(sumLo, belowV));
+		const __m128i hi = _mm_or_si128(_mm_cmpgt_epi16(sumHi, aboveV), _mm_cmplt_epi16(sumHi, belowV));
+		return static_cast<unsigned int>(_mm_movemask_epi8(_mm_packs_epi16(lo, hi)));
+	}
+
+	BMP2VOX_TARGET("sse2")
+	uint64_t Word32SSE2(const ebmpBYTE* p, const int above, const int below)
+	{
+		const __m128i aboveV = _mm_set1_epi16(static_cast<short>(above));
+		const __m128i belowV = _mm_set1_epi16(static_cast<short>(below));
+		uint64_t word = 0;
+		for (int i = 0; i < 4; ++i, p += 64)
+		{
+			const __m128i sumLo = _mm_packs_epi32(SumBGRA4(p),      SumBGRA4(p + 16));
+			const __m128i sumHi = _mm_packs_epi32(SumBGRA4(p + 32), SumBGRA4(p + 48));
+			word |= static_cast<uint64_t>(Mask16SSE2(sumLo, sumHi, aboveV, belowV)) << (16 * i);
+		}
+		return word;
+	}
+
+	// pshufb masks that gather channel c of 16 BGR pixels from the three 16-byte loads that hold them
+	struct BGRShuffles
+	{
+		BGRShuffles()
+		{
+			for (int c = 0; c < 3; ++c)
+				for (int v = 0; v < 3; ++v)
+					for (int k = 0; k < 16; ++k)
+					{
+						const int pos = 3 * k + c;
+						mask[c][v][k] = (pos / 16 == v) ? static_cast<char>(pos % 16) : static_cast<char>(0x80);
+					}
+		}
+		char mask[3][3][16];
+	};
+	const BGRShuffles kBGRShuffles;
+
+	BMP2VOX_TARGET("ssse3")
+	inline __m128i GatherChannel(const __m128i a0, const __m128i a1, const __m128i a2, const int c)
+	{
+		const char (*m)[16] = kBGRShuffles.mask[c];
+		return _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(m[0]))),
+										 _mm_shuffle_epi8(a1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(m[1])))),
+							_mm_shuffle_epi8(a2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(m[2]))));
+	}
+
+	BMP2VOX_TARGET("ssse3")
+	uint64_t Word24SSSE3(const ebmpBYTE* p, const int above, const int below)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i aboveV = _mm_set1_epi16(static_cast<short>(above));
+		const __m128i belowV = _mm_set1_epi16(static_cast<short>(below));
+		uint64_t word = 0;
+		for (int i = 0; i < 4; ++i, p += 48)
+		{
+			const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+			const __m128i a2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32));
+			const __m128i b = GatherChannel(a0, a1, a2, 0);
+			const __m128i g = GatherChannel(a0, a1, a2, 1);
+			const __m128i r = GatherChannel(a0, a1, a2, 2);
+			const __m128i sumLo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(g, zero)), _mm_unpacklo_epi8(r, zero));
+			const __m128i sumHi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(g, zero)), _mm_unpackhi_epi8(r, zero));
+			word |= static_cast<uint64_t>(Mask16SSE2(sumLo, sumHi, aboveV, belowV)) << (16 * i);
+		}
+		return word;
+	}
+
+	// *** AVX2 kernels, 32 pixels (8-bit) or 8 pixels (32-bit) per step
+
+	BMP2VOX_TARGET("avx2")
+	uint64_t Word8AVX2(const ebmpBYTE* p, const int above, const int below)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i aboveV = _mm256_set1_epi8(static_cast<char>(above + 1));
+		const __m256i belowV = _mm256_set1_epi8(static_cast<char>(below - 1));
+		uint64_t word = 0;
+		for (int i = 0; i < 2; ++i)
+		{
+			const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32 * i));
+			const __m256i gt = (above < 255) ? _mm256_cmpeq_epi8(_mm256_max_epu8(x, aboveV), x) : zero;
+			const __m256i lt = (below > 0) ? _mm256_cmpeq_epi8(_mm256_min_epu8(x, belowV), x) : zero;
+			word |= static_cast<uint64_t>(static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_or_si256(gt, lt)))) << (32 * i);
+		}
+		return word;
+	}
+
+	BMP2VOX_TARGET("avx2")
+	uint64_t Word32AVX2(const ebmpBYTE* p, const int above, const int below)
+	{
+		const __m256i aboveV = _mm256_set1_epi32(above);
+		const __m256i belowV = _mm256_set1_epi32(below);
+		const __m256i rgbMask = _mm256_set1_epi32(0x00FFFFFF);
+		const __m256i evenMask = _mm256_set1_epi32(0x00FF00FF);
+		const __m256i lowMask = _mm256_set1_epi32(0xFFFF);
+		uint64_t word = 0;
+		for (int i = 0; i < 8; ++i, p += 32)
+		{
+			const __m256i x = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), rgbMask);
+			const __m256i s16 = _mm256_add_epi16(_mm256_and_si256(x, evenMask), _mm256_srli_epi16(x, 8));
+			const __m256i sum = _mm256_add_epi32(_mm256_and_si256(s16, lowMask), _mm256_srli_epi32(s16, 16));
+			const __m256i fg = _mm256_or_si256(_mm256_cmpgt_epi32(sum, aboveV), _mm256_cmpgt_epi32(belowV, sum));
+			word |= static_cast<uint64_t>(static_cast<unsigned int>(_mm256_movemask_ps(_mm256_castsi256_ps(fg)))) << (8 * i);
+		}
+		return word;
+	}
+#endif // BMP2VOX_X86
+}
+
+ThresholdKernel::ThresholdKernel(const short threshold, const bool negate)
+: mGrayRamp(false),
+  mInstructionSet(kScalar),
+  mHasSSSE3(false)
+{
+	mSumAbove = Clamp(3 * threshold + 2, -1, 765);
+	mSumBelow = negate ? Clamp(3 * threshold, 0, 766) : 0;
+	mIndexAbove = Clamp(threshold, -1, 255);
+	mIndexBelow = negate ? Clamp(threshold, 0, 256) : 0;
+
+	for (int i = 0; i < 256; ++i)
+		mLut[i] = 0;
+
+	SetInstructionSet(DetectInstructionSet());
+}
+
+void ThresholdKernel::SetColorTable(const RGBApixel* colorTable)
+{
+	mGrayRamp = true;
+	for (int i = 0; i < 256; ++i)
+	{
+		const RGBApixel& c = colorTable[i];
+		const int sum = c.Red + c.Green + c.Blue;
+		mLut[i] = ((sum > mSumAbove) || (sum < mSumBelow)) ? 1 : 0;
+		mGrayRamp &= (c.Red == i && c.Green == i && c.Blue == i);
+	}
+}
+
+void ThresholdKernel::ThresholdRow(const ebmpBYTE* row, const int width, const int bitDepth, uint64_t* out) const
+{
+	const int bytesPerPixel = bitDepth / 8;
+	const int numWords = (width + 63) / 64;
+	const int fullWords = width / 64;
+
+	int w = 0;
+#ifdef BMP2VOX_X86
+	if (mInstructionSet == kAVX2)
+	{
+		if (bitDepth == 8 && mGrayRamp)
+			for (; w < fullWords; ++w)
+				out[w] = Word8AVX2(row + 64 * w, mIndexAbove, mIndexBelow);
+		else if (bitDepth == 32)
+			for (; w < fullWords; ++w)
+				out[w] = Word32AVX2(row + 256 * w, mSumAbove, mSumBelow);
+		else if (bitDepth == 24)
+			for (; w < fullWords; ++w)
+				out[w] = Word24SSSE3(row + 192 * w, mSumAbove, mSumBelow);
+	}
+	else if (mInstructionSet == kSSE2)
+	{
+		if (bitDepth == 8 && mGrayRamp)
+			for (; w < fullWords; ++w)
+				out[w] = Word8SSE2(row + 64 * w, mIndexAbove, mIndexBelow);
+		else if (bitDepth == 32)
+			for (; w < fullWords; ++w)
+				out[w] = Word32SSE2(row + 256 * w, mSumAbove, mSumBelow);
+		else if (bitDepth == 24 && mHasSSSE3)
+			for (; w < fullWords; ++w)
+				out[w] = Word24SSSE3(row + 192 * w, mSumAbove, mSumBelow);
+	}
+#endif
+
+	// Whatever the SIMD kernels didn't cover, including the partial word at the end of the row
+	for (; w < numWords; ++w)
+	{
+		const int n = std::min(64, width - 64 * w);
+		const ebmpBYTE* p = row + static_cast<size_t>(64) * w * bytesPerPixel;
+		out[w] = (bitDepth == 8) ? Word8Scalar(p, n, mLut)
+								 : WordRGBScalar(p, n, bytesPerPixel, mSumAbove, mSumBelow);
+	}
+}
+
+void ThresholdKernel::SetInstructionSet(const InstructionSet instructionSet)
+{
+	const InstructionSet best = DetectInstructionSet();
+	mInstructionSet = (instructionSet > best) ? best : instructionSet;
+
+	mHasSSSE3 = false;
+#ifdef BMP2VOX_X86
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	mHasSSSE3 = (info[2] & (1 << 9)) != 0;
+#else
+	mHasSSSE3 = __builtin_cpu_supports("ssse3") != 0;
+#endif
+#endif
+}
+
+ThresholdKernel::InstructionSet ThresholdKernel::DetectInstructionSet()
+{
+#ifdef BMP2VOX_X86
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	const int maxLeaf = info[0];
+	__cpuid(info, 1);
+	const bool sse2 = (info[3] & (1 << 26)) != 0;
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx2 = false;
+	if (maxLeaf >= 7 && osxsave && (_xgetbv(0) & 6) == 6)
+	{
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+	}
+#else
+	const bool sse2 = __builtin_cpu_supports("sse2") != 0;
+	const bool avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+	if (avx2)
+		return kAVX2;
+	if (sse2)
+		return kSSE2;
+#endif
+	return kScalar;
+}
+
+// EOF
@@ -0,0 +1,79 @@
+///  @file	Threshold.h
+///  @brief	Gray-level thresholding of bitmap pixels
+///
+///		A pixel is foreground if its gray-level (the mean of R, G and B) is
+///     above the threshold. With negate set, any gray-level other than the
+///     threshold itself is foreground.
+///
+///		ThresholdKernel applies that test to whole rows of raw bitmap data and
+///     packs the result into 64-bit occupancy words (bit x%64 of word x/64).
+///     It picks an AVX2, SSE2/SSSE3 or scalar implementation at run time;
+///     all of them produce the same bits.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <cstdint>
+#include "easybmp/EasyBMP.h"
+
+inline short PixColourAsShort(const RGBApixel* const pix)
+{
+	return (pix->Red + pix->Green + pix->Blue) / 3;
+}
+
+inline bool IsForeground(const short pix, const short threshold, const bool negate)
+{
+	return (pix > threshold) || (negate && (pix < threshold));
+}
+
+class ThresholdKernel
+{
+public:
+	enum InstructionSet
+	{
+		kScalar,
+		kSSE2,      // SSE2 for 8 and 32-bit rows, plus SSSE3 for 24-bit rows when the CPU has it
+		kAVX2
+	};
+
+	ThresholdKernel(const short threshold, const bool negate);
+
+	// Must be called before thresholding 8-bit rows
+	void SetColorTable(const RGBApixel* colorTable);
+
+	// Thresholds width pixels of an uncompressed 8, 24 or 32-bit bitmap row into
+	// (width + 63) / 64 words. Bits past width in the last word are cleared.
+	void ThresholdRow(const ebmpBYTE* row, const int width, const int bitDepth, uint64_t* out) const;
+
+	// RGBApixel is laid out like a 32-bit BMP pixel, so BMP::Row() can be thresholded directly
+	void ThresholdRow(const RGBApixel* row, const int width, uint64_t* out) const
+	{
+		ThresholdRow(reinterpret_cast<const ebmpBYTE*>(row), width, 32, out);
+	}
+
+	InstructionSet GetInstructionSet() const { return mInstructionSet; }
+	void SetInstructionSet(const InstructionSet instructionSet); // clamped to what the CPU supports
+
+	static InstructionSet DetectInstructionSet();
+
+protected:
+	// The test on the sum of R, G and B: foreground if sum > mSumAbove, or if sum < mSumBelow
+	// (mSumBelow is 0, i.e. never, unless negating). Both are clamped to [-1, 766].
+	int mSumAbove;
+	int mSumBelow;
+
+	// For 8-bit rows: a foreground flag per colour, and whether the table is the identity
+	// gray ramp (index i is (i, i, i)) so the index itself can be compared
+	unsigned char mLut[256];
+	bool mGrayRamp;
+	int mIndexAbove;
+	int mIndexBelow;
+
+	InstructionSet mInstructionSet;
+	bool mHasSSSE3;
+};
@@ -0,0 +1,104 @@
+///  @file	TraceRecorder.cpp
+///  @brief	Implements class: TraceRecorder
+///
+///		Records a Chrome trace_event timeline of the run. See TraceRecorder.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "TraceRecorder.h"
+
+#include <atomic>
+#include <cstdio>
+
+namespace
+{
+	const size_t kInitialEvents = 4096;
+
+	std::atomic<uint64_t> gNextRecorderId(1);
+
+	// The calling thread's buffer in the most recent recorder it recorded to
+	struct CachedBuffer
+	{
+		uint64_t recorderId;
+		void* buffer;
+	};
+	thread_local CachedBuffer tCachedBuffer = { 0, NULL };
+
+	// Microseconds, as trace_event timestamps are
+	void AppendMicroseconds(std::ostream& os, const int64_t nanoseconds)
+	{
+		char text[32];
+		snprintf(text, sizeof(text), "%.3f", nanoseconds * 1e-3);
+		os << text;
+	}
+}
+
+TraceRecorder::TraceRecorder()
+: mStart(Clock::now()),
+  mId(gNextRecorderId++)
+{
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::GetThreadBuffer()
+{
+	if (tCachedBuffer.recorderId == mId)
+		return *static_cast<ThreadBuffer*>(tCachedBuffer.buffer);
+
+	// First event from this thread
+	std::lock_guard<std::mutex> lock(mMutex);
+	mBuffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer));
+	ThreadBuffer& buffer = *mBuffers.back();
+	buffer.tid = static_cast<int>(mBuffers.size());
+	buffer.name = NULL;
+	buffer.events.reserve(kInitialEvents);
+
+	tCachedBuffer.recorderId = mId;
+	tCachedBuffer.buffer = &buffer;
+	return buffer;
+}
+
+void TraceRecorder::AddEvent(const char* name, const Clock::time_point& start, const Clock::time_point& end, const int slice)
+{
+	const Event event = { name,
+						  std::chrono::duration_cast<std::chrono::nanoseconds>(start - mStart).count(),
+						  std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(),
+						  slice };
+	GetThreadBuffer().events.push_back(event);
+}
+
+void TraceRecorder::NameThread(const char* name)
+{
+	GetThreadBuffer().name = name;
+}
+
+void TraceRecorder::WriteJson(std::ostream& os) const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"bmp2vox\"}}";
+	for (size_t b = 0; b < mBuffers.size(); ++b)
+	{
+		const ThreadBuffer& buffer = *mBuffers[b];
+		os << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.tid
+		   << ",\"args\":{\"name\":\"" << (buffer.name ? buffer.name : "worker") << "\"}}";
+
+		for (auto event = buffer.events.begin(); event != buffer.events.end(); ++event)
+		{
+			os << ",\n{\"name\":\"" << event->name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.tid << ",\"ts\":";
+			AppendMicroseconds(os, event->start);
+			os << ",\"dur\":";
+			AppendMicroseconds(os, event->duration);
+			if (event->slice >= 0)
+				os << ",\"args\":{\"slice\":" << event->slice << "}";
+			os << "}";
+		}
+	}
+	os << "\n]}\n";
+}
+
+// EOF
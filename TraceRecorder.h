@@ -0,0 +1,102 @@
+///  @file	TraceRecorder.h
+///  @brief	Implements classes: TraceRecorder, TraceScope
+///
+///		Records a timeline of the run for --trace, written in the Chrome
+///     trace_event JSON format (open it in chrome://tracing or Perfetto).
+///
+///		Every event is a complete ("X") event with the stage name, its start
+///     and duration, and the slice it belongs to when there is one. Events go
+///     to a buffer owned by the recording thread, so recording an event is a
+///     push_back with no lock; the buffers are only gathered by WriteJson(),
+///     which must be called once the other threads have stopped recording.
+///
+///		Stage events come from StageTimer (see RunStats.h) once a recorder is
+///     attached with RunStats::SetTracer(). TraceScope records other spans,
+///     such as the whole of a slice on the main thread.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+#include <cstdint>
+
+class TraceRecorder
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	TraceRecorder();
+
+	// name must outlive the recorder (a string literal). slice is -1 for events not tied to a slice.
+	void AddEvent(const char* name, const Clock::time_point& start, const Clock::time_point& end, const int slice = -1);
+
+	// Names the calling thread in the timeline. name must outlive the recorder.
+	void NameThread(const char* name);
+
+	void WriteJson(std::ostream& os) const;
+
+protected:
+	TraceRecorder(const TraceRecorder&);            // not copyable
+	TraceRecorder& operator=(const TraceRecorder&);
+
+	struct Event
+	{
+		const char* name;
+		int64_t start;      // nanoseconds since mStart
+		int64_t duration;   // nanoseconds
+		int slice;
+	};
+
+	struct ThreadBuffer
+	{
+		int tid;
+		const char* name;
+		std::vector<Event> events;
+	};
+
+	ThreadBuffer& GetThreadBuffer();
+
+	const Clock::time_point mStart;
+	const uint64_t mId;     // tells this recorder's thread buffers from those of an earlier one
+
+	mutable std::mutex mMutex;  // guards mBuffers (not the buffers' events)
+	std::vector<std::unique_ptr<ThreadBuffer> > mBuffers;
+};
+
+// Records an event from construction to destruction, if trace is not NULL
+class TraceScope
+{
+public:
+	TraceScope(TraceRecorder* trace, const char* name, const int slice = -1)
+	: mTrace(trace),
+	  mName(name),
+	  mSlice(slice)
+	{
+		if (mTrace)
+			mStart = TraceRecorder::Clock::now();
+	}
+
+	~TraceScope()
+	{
+		if (mTrace)
+			mTrace->AddEvent(mName, mStart, TraceRecorder::Clock::now(), mSlice);
+	}
+
+protected:
+	TraceScope(const TraceScope&);            // not copyable
+	TraceScope& operator=(const TraceScope&);
+
+	TraceRecorder* const mTrace;
+	const char* const mName;
+	const int mSlice;
+	TraceRecorder::Clock::time_point mStart;
+};
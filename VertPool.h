@@ -21,6 +21,9 @@
 #include <map>
 #include <utility> // std::pair
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 
 #define LOG_ERROR(x) { std::cout << "ERR " << __FILE__ << "(" << __LINE__ << "), " << x << std::endl; }
 #define LOG(x)		 { std::cout << "INF " << __FILE__ << "(" << __LINE__ << "), " << x << std::endl; }
@@ -29,9 +32,9 @@
 typedef std::set<unsigned int> SetUInt;
 typedef std::map<unsigned int, SetUInt > MapUIntToSetUInt;
 typedef std::set<unsigned int> SetUShort;
-typedef unsigned int KeyType; // mPoolDim up to 1024 use KeyType uint. 2048 and above use KeyType ulong
+typedef uint64_t KeyType;    // zi * dim^2 + yi * dim + xi, so dim can be up to 2^21
 typedef unsigned char RefCountType; 
-typedef unsigned int VertIdType; 
+typedef uint64_t VertIdType; // node and element IDs; stacks can have more than 2^32 of either
 
 class Vec3
 {
@@ -71,6 +74,25 @@ struct SIMPLE_VERTEX
 	Vec3 pos, norm;
 };
 
+// Cells outside [0, dim) are clamped to the edge cell. They used to wrap (modulo dim), which
+// merged nodes on opposite sides of the pool, and negative positions wrapped through unsigned.
+inline KeyType GetVertPoolCell(const float v, const float min, const float span, const KeyType dim)
+{
+	const double cell = std::floor(((static_cast<double>(v) + min) / span/* + 0.5f*/) * static_cast<double>(dim));
+	return static_cast<KeyType>(std::min(std::max(cell, 0.0), static_cast<double>(dim - 1)));
+}
+
+// The key of the cell that (x, y, z) falls in. Verts in the same cell are pooled together.
+inline KeyType GetVertPoolKey(const float x, const float y, const float z,
+							  const KeyType dim, const Vec3& min, const Vec3& span)
+{
+	const KeyType xi = GetVertPoolCell(x, min.x, span.x, dim);
+	const KeyType yi = GetVertPoolCell(y, min.y, span.y, dim);
+	const KeyType zi = GetVertPoolCell(z, min.z, span.z, dim);
+
+	return zi * (dim * dim) + yi * dim + xi;
+}
+
 template<class VertT>
 class VertPool
 {
@@ -82,8 +104,8 @@ public:
 	void RemoveVertRef(const Vec3& pos);
 
 protected:
-	unsigned int GetKey(const Vec3& p) const;
-	unsigned int GetKey(const float x, const float y, const float z) const;
+	KeyType GetKey(const Vec3& p) const;
+	KeyType GetKey(const float x, const float y, const float z) const;
 
 	std::vector<VertT> mVerts;
 
@@ -118,7 +140,7 @@ const VertIdType& VertPool<VertT>::AddVertRef(const VertT& v)
 		// If we don't have any locations in the vert-pool available
 		if (mAvailable.empty())
 		{
-			mRefs[key] = make_pair(mVerts.size(), 1); // insert an entry into the vert-pool
+			mRefs[key] = std::make_pair(mVerts.size(), 1); // insert an entry into the vert-pool
 			mVerts.push_back(v);
 		}
 		else
@@ -181,13 +203,9 @@ void VertPool<VertT>::RemoveVertRef(const Vec3& pos)
 }
 
 template<class VertT>
-unsigned int VertPool<VertT>::GetKey(const float x, const float y, const float z) const
+KeyType VertPool<VertT>::GetKey(const float x, const float y, const float z) const
 {
-	const KeyType xi = static_cast<KeyType>(((x + mMin.x) / mSpan.x/* + 0.5f*/) * mDimFlt) % mDim;
-	const KeyType yi = static_cast<KeyType>(((y + mMin.y) / mSpan.y/* + 0.5f*/) * mDimFlt) % mDim;
-	const KeyType zi = static_cast<KeyType>(((z + mMin.z) / mSpan.z/* + 0.5f*/) * mDimFlt) % mDim;
-
-	return zi * (mDim * mDim) + yi * mDim + xi;
+	return GetVertPoolKey(x, y, z, mDim, mMin, mSpan);
 }
 
 //template<class VertT>
@@ -197,7 +215,7 @@ unsigned int VertPool<VertT>::GetKey(const float x, const float y, const float z
 //}
 //
 template<class VertT>
-unsigned int VertPool<VertT>::GetKey(const Vec3& p) const
+KeyType VertPool<VertT>::GetKey(const Vec3& p) const
 {
 	return GetKey(p.x, p.y, p.z);
 }
@@ -0,0 +1,503 @@
+///  @file	Bmp2VoxBench.cpp
+///  @brief	Benchmark: the stages of bmp2vox on synthetic CT stacks
+///
+///		Generates a trabecular-like BMP stack (see SyntheticStack.h) at each
+///     requested size, then times each stage of the conversion on it:
+///
+///		  decode     BMP::ReadFromFile, and MappedBitmap with ThresholdKernel,
+///		             also on a top-down copy of the stack that only it can read
+///		  threshold  PixColourAsShort per pixel, and ThresholdKernel::ThresholdRow
+///		  pooling    VertPool::AddVertRef per corner, and LatticeNodePool runs
+///		  writing    ostream insertion, AsciiMeshFormat and BinaryMeshFormat
+///
+///		Each stage reports the best of a few repeats as stack voxels per second,
+///     and bytes per second of what the stage reads (bitmaps, pixels) or
+///     produces (node IDs, output text). The per-pixel and per-corner paths
+///     are what bmp2vox originally did, so the pairs show what each newer
+///     path buys. The paired stages are also checked to agree.
+///
+///		Usage: bmp2vox_bench [--sizes 64,128,256] [--depth 32] [--bits 24]
+///		                     [--porosity 0.75] [--feature 12] [--seed 1]
+///		                     [--repeats 3] [--t 128] [--dir bmp2vox_bench_stacks] [--keep]
+///		       bmp2vox_bench --generate <folder> [--size 256x256x32] [--bits ...] [--top-down]
+///
+///		The second form only writes a stack, e.g. to run bmp2vox itself on.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include "easybmp/EasyBMP.h"
+#include "Threshold.h"
+#include "MappedBitmap.h"
+#include "OccupancySlice.h"
+#include "VertPool.h"
+#include "LatticeNodePool.h"
+#include "MeshFormat.h"
+#include "SyntheticStack.h"
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	double SecondsSince(const Clock::time_point& start)
+	{
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	struct Options
+	{
+		Options()
+		: repeats(3),
+		  threshold(128),
+		  dir("bmp2vox_bench_stacks"),
+		  keep(false),
+		  topDown(false)
+		{
+			sizes.push_back(64);
+			sizes.push_back(128);
+			sizes.push_back(256);
+		}
+
+		SyntheticStackParams stack;
+		std::vector<int> sizes;
+		int repeats;
+		short threshold;
+		std::string dir;
+		bool keep;
+		bool topDown;
+		std::string generate;
+	};
+
+	bool ParseOptions(const int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string name = argv[i];
+			if (name == "--keep")
+			{
+				options.keep = true;
+				continue;
+			}
+			if (name == "--top-down")
+			{
+				options.topDown = true;
+				continue;
+			}
+			if (i + 1 >= argc)
+				return false;
+
+			const char* value = argv[++i];
+			if (name == "--sizes")
+			{
+				options.sizes.clear();
+				for (const char* p = value; *p; )
+				{
+					char* end;
+					options.sizes.push_back(static_cast<int>(strtol(p, &end, 10)));
+					if (end == p || options.sizes.back() <= 0)
+						return false;
+					p = (*end == ',') ? end + 1 : end;
+				}
+			}
+			else if (name == "--size")
+			{
+				if (sscanf(value, "%dx%dx%d", &options.stack.width, &options.stack.height, &options.stack.depth) != 3)
+					return false;
+			}
+			else if (name == "--depth")     options.stack.depth = atoi(value);
+			else if (name == "--bits")      options.stack.bitDepth = atoi(value);
+			else if (name == "--porosity")  options.stack.porosity = atof(value);
+			else if (name == "--feature")   options.stack.featureSize = atof(value);
+			else if (name == "--seed")      options.stack.seed = static_cast<uint32_t>(strtoul(value, NULL, 10));
+			else if (name == "--repeats")   options.repeats = atoi(value);
+			else if (name == "--t")         options.threshold = static_cast<short>(atoi(value));
+			else if (name == "--dir")       options.dir = value;
+			else if (name == "--generate")  options.generate = value;
+			else
+				return false;
+		}
+
+		// The benchmark decodes with BMP::ReadFromFile, so it makes its own top-down copy
+		options.stack.topDown = options.topDown;
+		if (options.topDown && options.generate.empty())
+			return false;
+
+		const int bits = options.stack.bitDepth;
+		return (bits == 1 || bits == 8 || bits == 24 || bits == 32) && options.repeats > 0 &&
+			   options.stack.width > 0 && options.stack.height > 0 && options.stack.depth > 0;
+	}
+
+	void Report(const char* name, const double seconds, const uint64_t voxels, const uint64_t bytes)
+	{
+		printf("  %-36s %9.3f ms  %8.1f Mvox/s  %8.1f MB/s\n",
+			   name, seconds * 1e3, voxels / seconds / 1e6, bytes / seconds / 1e6);
+	}
+
+	void ReportSkipped(const char* name, const char* reason)
+	{
+		printf("  %-36s %s\n", name, reason);
+	}
+
+	uint64_t CountSetBits(const OccupancySlice& slice)
+	{
+		uint64_t count = 0;
+		for (int y = 0; y < slice.GetHeight(); ++y)
+		{
+			const uint64_t* row = slice.GetRow(y);
+			for (int w = 0; w < slice.GetWordsPerRow(); ++w)
+				for (uint64_t bits = row[w]; bits; bits &= bits - 1)
+					++count;
+		}
+		return count;
+	}
+
+	// The formats and writers need nodes and elements as bmp2vox produces them, one slice at a time
+	struct MeshSlice
+	{
+		std::vector<VertIdType> elements;
+		std::vector<Vec3> nodes;
+		VertIdType firstNodeId;
+		uint64_t firstElementId;
+	};
+
+	void WriteWithOstream(std::ostream& os, const MeshSlice& mesh)
+	{
+		// As bmp2vox wrote its text files before MeshFormat
+		const std::string sep = ",\t";
+		const size_t numElements = mesh.elements.size() / 8;
+		for (size_t i = 0; i < numElements; ++i)
+		{
+			const VertIdType* e = &mesh.elements[8 * i];
+			os << "\t" << (mesh.firstElementId + i) << sep << (1 + e[0]) << sep << (1 + e[1]) << sep << (1 + e[2]) << sep
+			   << (1 + e[3]) << sep << (1 + e[4]) << sep << (1 + e[5]) << sep << (1 + e[6]) << sep << (1 + e[7]) << "\n";
+		}
+		for (size_t i = 0; i < mesh.nodes.size(); ++i)
+		{
+			const Vec3& v = mesh.nodes[i];
+			os << "\t" << (mesh.firstNodeId + i + 1) << sep << v.x << sep << v.y << sep << v.z << "\n";
+		}
+	}
+
+	double TimeFormat(MeshFormat& format, const std::vector<MeshSlice>& meshes, uint64_t& bytes)
+	{
+		std::string block;
+		bytes = 0;
+		const Clock::time_point start = Clock::now();
+		for (size_t z = 0; z < meshes.size(); ++z)
+		{
+			const MeshSlice& mesh = meshes[z];
+			block.clear();
+			format.AppendElements(block, mesh.firstElementId, mesh.elements.data(), mesh.elements.size() / 8);
+			format.AppendNodes(block, mesh.firstNodeId, mesh.nodes.data(), mesh.nodes.size());
+			bytes += block.size();
+		}
+		return SecondsSince(start);
+	}
+
+	// Runs every stage on one stack. Returns false if paired stages disagree.
+	bool BenchStack(const Options& options, const SyntheticStackParams& params)
+	{
+		const SyntheticStack stack(params);
+		const int width = params.width, height = params.height, depth = params.depth;
+		const uint64_t voxels = static_cast<uint64_t>(width) * height * depth;
+		const uint64_t fileBytes = stack.GetSliceFileSize() * depth;
+		const uint64_t pixelBytes = voxels * sizeof(RGBApixel);
+		const int repeats = options.repeats;
+
+		char name[64];
+		snprintf(name, sizeof(name), "%dx%dx%d-%d", width, height, depth, params.bitDepth);
+		const boost::filesystem::path folder = boost::filesystem::path(options.dir) / name;
+		boost::filesystem::create_directories(folder);
+
+		std::vector<std::string> filenames;
+		Clock::time_point start = Clock::now();
+		if (!stack.Write(folder.generic_string(), &filenames))
+		{
+			printf("Unable to write the stack to \"%s\"\n", folder.generic_string().c_str());
+			return false;
+		}
+		const double generateSeconds = SecondsSince(start);
+
+		// The same stack with top-down rows, which BMP::ReadFromFile can't read
+		SyntheticStackParams topDownParams = params;
+		topDownParams.topDown = true;
+		const SyntheticStack topDownStack(topDownParams);
+		const boost::filesystem::path topDownFolder = folder.generic_string() + "-topdown";
+		boost::filesystem::create_directories(topDownFolder);
+		std::vector<std::string> topDownFilenames;
+		if (!topDownStack.Write(topDownFolder.generic_string(), &topDownFilenames))
+		{
+			printf("Unable to write the stack to \"%s\"\n", topDownFolder.generic_string().c_str());
+			return false;
+		}
+
+		bool same = true;
+		double readSeconds = 1e30, mappedSeconds = 1e30, topDownSeconds = 1e30, pixSeconds = 1e30, kernelSeconds = 1e30;
+		double vertPoolSeconds = 1e30, latticeSeconds = 1e30, ostreamSeconds = 1e30, asciiSeconds = 1e30, binarySeconds = 1e30;
+		uint64_t pixCount = 0, kernelCount = 0, mappedCount = 0;
+		uint64_t ostreamBytes = 0, asciiBytes = 0, binaryBytes = 0;
+		bool mappedOk = true;
+
+		const ThresholdKernel kernel(options.threshold, false);
+		std::vector<BMP> bmps(depth);
+		std::vector<OccupancySlice> slices(depth);
+		std::vector<OccupancySlice> topDownSlices(depth);
+		std::vector<MeshSlice> meshes(depth);
+		std::vector<VertIdType> vertPoolIds;
+		for (int r = 0; r < repeats; ++r)
+		{
+			// Decode
+			start = Clock::now();
+			for (int z = 0; z < depth; ++z)
+				same &= bmps[z].ReadFromFile(filenames[z].c_str());
+			readSeconds = std::min(readSeconds, SecondsSince(start));
+
+			start = Clock::now();
+			mappedCount = 0;
+			for (int z = 0; z < depth && mappedOk; ++z)
+			{
+				MappedBitmap mapped;
+				if (!mapped.Open(filenames[z].c_str()))
+				{
+					mappedOk = false;
+					break;
+				}
+				ThresholdKernel mappedKernel(kernel);
+				if (mapped.GetColorTable())
+					mappedKernel.SetColorTable(mapped.GetColorTable());
+				OccupancySlice& slice = slices[z];
+				slice.Resize(width, height);
+				for (int y = 0; y < height; ++y)
+					mappedKernel.ThresholdRow(mapped.GetRow(y), width, mapped.GetBitDepth(), slice.GetRow(y));
+				mappedCount += CountSetBits(slice);
+			}
+			mappedSeconds = std::min(mappedSeconds, SecondsSince(start));
+
+			start = Clock::now();
+			for (int z = 0; z < depth && mappedOk; ++z)
+			{
+				MappedBitmap mapped;
+				if (!mapped.Open(topDownFilenames[z].c_str()))
+				{
+					mappedOk = false;
+					break;
+				}
+				ThresholdKernel mappedKernel(kernel);
+				if (mapped.GetColorTable())
+					mappedKernel.SetColorTable(mapped.GetColorTable());
+				OccupancySlice& slice = topDownSlices[z];
+				slice.Resize(width, height);
+				for (int y = 0; y < height; ++y)
+					mappedKernel.ThresholdRow(mapped.GetRow(y), width, mapped.GetBitDepth(), slice.GetRow(y));
+			}
+			topDownSeconds = std::min(topDownSeconds, SecondsSince(start));
+
+			// Threshold, from the decoded BMPs
+			start = Clock::now();
+			pixCount = 0;
+			for (int z = 0; z < depth; ++z)
+			{
+				BMP& bmp = bmps[z];
+				for (int y = 0; y < height; ++y)
+					for (int x = 0; x < width; ++x)
+						pixCount += IsForeground(PixColourAsShort(bmp(x, y)), options.threshold, false) ? 1 : 0;
+			}
+			pixSeconds = std::min(pixSeconds, SecondsSince(start));
+
+			start = Clock::now();
+			for (int z = 0; z < depth; ++z)
+			{
+				OccupancySlice& slice = slices[z];
+				slice.Resize(width, height);
+				for (int y = 0; y < height; ++y)
+					kernel.ThresholdRow(bmps[z].Row(y), width, slice.GetRow(y));
+				slice.UpdateSummary();
+			}
+			kernelSeconds = std::min(kernelSeconds, SecondsSince(start));
+
+			kernelCount = 0;
+			for (int z = 0; z < depth; ++z)
+				kernelCount += CountSetBits(slices[z]);
+
+			// Pooling: eight AddVertRef calls per voxel, as bmp2vox originally meshed. GetVertPoolKey adds
+			// minVert to a position, so (1, 1, 1) with 1.2 cells per unit of the largest dimension keeps
+			// every lattice point in a cell of its own.
+			{
+				const int keyDim = std::max(width, std::max(height, depth));
+				VertPool<SIMPLE_VERTEX> vertPool(static_cast<KeyType>(keyDim * 1.2f), Vec3(1.0f, 1.0f, 1.0f),
+												 Vec3(width + 2.0f, height + 2.0f, depth + 2.0f));
+				vertPoolIds.clear();
+				start = Clock::now();
+				for (int z = 0; z < depth; ++z)
+				{
+					const OccupancySlice& slice = slices[z];
+					for (int y = 0; y < height; ++y)
+						for (int x = 0; x < width; ++x)
+						{
+							if (!slice.IsSet(x, y))
+								continue;
+							for (int c = 0; c < 8; ++c)
+							{
+								const Vec3 corner(static_cast<float>(x + (c & 1)),
+												  static_cast<float>(y + ((c >> 1) & 1)),
+												  static_cast<float>(z + (c >> 2)));
+								vertPoolIds.push_back(vertPool.AddVertRef(SIMPLE_VERTEX(corner)));
+							}
+						}
+				}
+				vertPoolSeconds = std::min(vertPoolSeconds, SecondsSince(start));
+			}
+
+			{
+				LatticeNodePool nodePool(0, 0, width, height);
+				std::vector<int> runs;
+				uint64_t elementCount = 0;
+				start = Clock::now();
+				for (int z = 0; z < depth; ++z)
+				{
+					const OccupancySlice& slice = slices[z];
+					MeshSlice& mesh = meshes[z];
+					mesh.elements.clear();
+					nodePool.BeginSlice(z);
+					for (int y = 0; y < height; ++y)
+					{
+						runs.clear();
+						slice.AppendRuns(y, 0, width, runs);
+						for (size_t i = 0; i < runs.size(); i += 2)
+							nodePool.AppendRunElements(runs[i], runs[i + 1], y, mesh.elements);
+					}
+					mesh.firstElementId = elementCount + 1;
+					mesh.firstNodeId = nodePool.GetFirstPendingId();
+					mesh.nodes = nodePool.GetPendingNodes();
+					nodePool.ClearPendingNodes();
+					elementCount += mesh.elements.size() / 8;
+				}
+				latticeSeconds = std::min(latticeSeconds, SecondsSince(start));
+			}
+
+			// Writing
+			{
+				std::ostringstream os;
+				ostreamBytes = 0;
+				start = Clock::now();
+				for (int z = 0; z < depth; ++z)
+				{
+					os.str(std::string());
+					WriteWithOstream(os, meshes[z]);
+					ostreamBytes += static_cast<uint64_t>(os.tellp());
+				}
+				ostreamSeconds = std::min(ostreamSeconds, SecondsSince(start));
+			}
+
+			AsciiMeshFormat ascii;
+			asciiSeconds = std::min(asciiSeconds, TimeFormat(ascii, meshes, asciiBytes));
+			BinaryMeshFormat binary(width, height, depth);
+			binarySeconds = std::min(binarySeconds, TimeFormat(binary, meshes, binaryBytes));
+		}
+
+		// The lattice pool writes corners (x, y), (x+1, y), (x+1, y+1), (x, y+1) of each face, VertPool was called in bit order
+		static const int kCornerOrder[8] = { 0, 1, 3, 2, 4, 5, 7, 6 };
+		size_t id = 0;
+		for (int z = 0; z < depth && same; ++z)
+		{
+			const std::vector<VertIdType>& elements = meshes[z].elements;
+			for (size_t i = 0; i < elements.size(); i += 8, id += 8)
+				for (int c = 0; c < 8; ++c)
+					same &= (id + kCornerOrder[c] < vertPoolIds.size()) && (elements[i + c] == vertPoolIds[id + kCornerOrder[c]]);
+		}
+		same &= (id == vertPoolIds.size()) && (pixCount == kernelCount) && (!mappedOk || mappedCount == kernelCount);
+		same &= (ostreamBytes == asciiBytes);
+
+		// Top-down rows come out as the same slices
+		for (int z = 0; z < depth && mappedOk; ++z)
+			for (int y = 0; y < height; ++y)
+				same &= std::equal(slices[z].GetRow(y), slices[z].GetRow(y) + slices[z].GetWordsPerRow(), topDownSlices[z].GetRow(y));
+
+		const uint64_t indexBytes = kernelCount * 8 * sizeof(VertIdType);
+		printf("%d x %d x %d, %d-bit, porosity %.2f: %llu voxels, %llu foreground, %.1f MB of bitmaps, best of %d\n",
+			   width, height, depth, params.bitDepth, params.porosity,
+			   static_cast<unsigned long long>(voxels), static_cast<unsigned long long>(kernelCount), fileBytes / 1e6, repeats);
+		Report("generate (SyntheticStack)", generateSeconds, voxels, fileBytes);
+		Report("decode BMP::ReadFromFile", readSeconds, voxels, fileBytes);
+		if (mappedOk)
+		{
+			Report("decode MappedBitmap + ThresholdKernel", mappedSeconds, voxels, fileBytes);
+			Report("decode MappedBitmap top-down", topDownSeconds, voxels, fileBytes);
+		}
+		else
+		{
+			ReportSkipped("decode MappedBitmap + ThresholdKernel", "n/a (bit depth not mapped)");
+			ReportSkipped("decode MappedBitmap top-down", "n/a (bit depth not mapped)");
+		}
+		Report("threshold PixColourAsShort", pixSeconds, voxels, pixelBytes);
+		Report("threshold ThresholdKernel::ThresholdRow", kernelSeconds, voxels, pixelBytes);
+		Report("pool VertPool::AddVertRef", vertPoolSeconds, voxels, indexBytes);
+		Report("pool LatticeNodePool runs", latticeSeconds, voxels, indexBytes);
+		Report("write ostream <<", ostreamSeconds, voxels, ostreamBytes);
+		Report("write AsciiMeshFormat", asciiSeconds, voxels, asciiBytes);
+		Report("write BinaryMeshFormat", binarySeconds, voxels, binaryBytes);
+
+		if (!options.keep)
+		{
+			boost::filesystem::remove_all(folder);
+			boost::filesystem::remove_all(topDownFolder);
+		}
+		return same;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		printf("Usage: bmp2vox_bench [--sizes 64,128,256] [--depth 32] [--bits 1|8|24|32] [--porosity 0.75]\n"
+			   "                     [--feature 12] [--seed 1] [--repeats 3] [--t 128] [--dir folder] [--keep]\n"
+			   "       bmp2vox_bench --generate <folder> [--size 256x256x32] [--bits ...] [--porosity ...] [--top-down]\n");
+		return 1;
+	}
+	SetEasyBMPwarningsOff();
+
+	if (!options.generate.empty())
+	{
+		boost::filesystem::create_directories(options.generate);
+		const SyntheticStack stack(options.stack);
+		if (!stack.Write(options.generate))
+		{
+			printf("Unable to write the stack to \"%s\"\n", options.generate.c_str());
+			return 1;
+		}
+		return 0;
+	}
+
+	printf("Threshold kernel instruction set: %d (0 scalar, 1 SSE2, 2 AVX2)\n", ThresholdKernel::DetectInstructionSet());
+	bool same = true;
+	for (size_t i = 0; i < options.sizes.size(); ++i)
+	{
+		SyntheticStackParams params = options.stack;
+		params.width = params.height = options.sizes[i];
+		same &= BenchStack(options, params);
+	}
+	if (!options.keep)
+	{
+		boost::system::error_code ignored;
+		boost::filesystem::remove(options.dir, ignored);    // only if nothing else is in it
+	}
+
+	printf("Stages agree: %s\n", same ? "yes" : "NO");
+	return same ? 0 : 1;
+}
+
+// EOF
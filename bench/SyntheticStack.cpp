@@ -0,0 +1,255 @@
+///  @file	SyntheticStack.cpp
+///  @brief	Implements class: SyntheticStack
+///
+///		Generates reproducible trabecular-like BMP stacks. See SyntheticStack.h.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include "SyntheticStack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+	const int kCutoffSamples = 16384;
+
+	// A well-mixed 32-bit hash of a lattice point
+	uint32_t HashPoint(const int x, const int y, const int z, const uint32_t seed)
+	{
+		uint32_t h = seed * 0x9E3779B1u;
+		h ^= static_cast<uint32_t>(x) * 0x85EBCA77u;
+		h ^= static_cast<uint32_t>(y) * 0xC2B2AE3Du;
+		h ^= static_cast<uint32_t>(z) * 0x27D4EB2Fu;
+		h ^= h >> 16;
+		h *= 0x7FEB352Du;
+		h ^= h >> 15;
+		h *= 0x846CA68Bu;
+		h ^= h >> 16;
+		return h;
+	}
+
+	float HashToUnit(const uint32_t h)
+	{
+		return static_cast<float>(h >> 8) / 16777216.0f;
+	}
+
+	float SmoothStep(const float t)
+	{
+		return t * t * (3.0f - 2.0f * t);
+	}
+
+	float Lerp(const float a, const float b, const float t)
+	{
+		return a + (b - a) * t;
+	}
+
+	// Value noise in [0, 1) on a lattice of the given spacing
+	float ValueNoise(const float x, const float y, const float z, const float spacing, const uint32_t seed)
+	{
+		const float fx = x / spacing, fy = y / spacing, fz = z / spacing;
+		const int ix = static_cast<int>(std::floor(fx));
+		const int iy = static_cast<int>(std::floor(fy));
+		const int iz = static_cast<int>(std::floor(fz));
+		const float tx = SmoothStep(fx - ix), ty = SmoothStep(fy - iy), tz = SmoothStep(fz - iz);
+
+		float c[2][2][2];
+		for (int dz = 0; dz < 2; ++dz)
+			for (int dy = 0; dy < 2; ++dy)
+				for (int dx = 0; dx < 2; ++dx)
+					c[dz][dy][dx] = HashToUnit(HashPoint(ix + dx, iy + dy, iz + dz, seed));
+
+		const float y0 = Lerp(Lerp(c[0][0][0], c[0][0][1], tx), Lerp(c[0][1][0], c[0][1][1], tx), ty);
+		const float y1 = Lerp(Lerp(c[1][0][0], c[1][0][1], tx), Lerp(c[1][1][0], c[1][1][1], tx), ty);
+		return Lerp(y0, y1, tz);
+	}
+
+	void Put16(std::vector<unsigned char>& out, const uint32_t value)
+	{
+		out.push_back(static_cast<unsigned char>(value));
+		out.push_back(static_cast<unsigned char>(value >> 8));
+	}
+
+	void Put32(std::vector<unsigned char>& out, const uint32_t value)
+	{
+		Put16(out, value & 0xFFFF);
+		Put16(out, value >> 16);
+	}
+
+	size_t RowStride(const int width, const int bitDepth)
+	{
+		return ((static_cast<size_t>(width) * bitDepth + 31) / 32) * 4;
+	}
+
+	int PaletteSize(const int bitDepth)
+	{
+		return (bitDepth == 1) ? 2 : (bitDepth == 8) ? 256 : 0;
+	}
+}
+
+SyntheticStack::SyntheticStack(const SyntheticStackParams& params)
+: mParams(params),
+  mCutoff(0.0f)
+{
+	mParams.porosity = std::min(std::max(mParams.porosity, 0.0), 1.0);
+	mParams.featureSize = std::max(mParams.featureSize, 2.0);
+
+	// The ridge value that the requested fraction of voxels falls below
+	std::vector<float> samples(kCutoffSamples);
+	uint32_t state = mParams.seed * 747796405u + 2891336453u;
+	for (int i = 0; i < kCutoffSamples; ++i)
+	{
+		const int x = static_cast<int>((state = state * 1664525u + 1013904223u) >> 8) % std::max(mParams.width, 1);
+		const int y = static_cast<int>((state = state * 1664525u + 1013904223u) >> 8) % std::max(mParams.height, 1);
+		const int z = static_cast<int>((state = state * 1664525u + 1013904223u) >> 8) % std::max(mParams.depth, 1);
+		samples[i] = Ridge(x, y, z);
+	}
+	std::sort(samples.begin(), samples.end());
+	const int index = std::min(static_cast<int>(mParams.porosity * kCutoffSamples), kCutoffSamples - 1);
+	mCutoff = (mParams.porosity >= 1.0) ? 1.0f : samples[index];
+}
+
+float SyntheticStack::Field(const float x, const float y, const float z) const
+{
+	const float spacing = static_cast<float>(mParams.featureSize);
+	return (ValueNoise(x, y, z, spacing, mParams.seed) +
+			0.5f * ValueNoise(x, y, z, 0.5f * spacing, mParams.seed + 1)) / 1.5f;
+}
+
+float SyntheticStack::Ridge(const int x, const int y, const int z) const
+{
+	// 1 on the noise's mid-level surface, falling to 0 away from it: plates and struts, not blobs
+	const float f = Field(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z));
+	return 1.0f - std::fabs(2.0f * f - 1.0f);
+}
+
+unsigned char SyntheticStack::GetGray(const int x, const int y, const int z) const
+{
+	const float r = Ridge(x, y, z);
+	float gray;
+	if (r > mCutoff)
+		gray = 150.0f + 90.0f * (r - mCutoff) / std::max(1.0f - mCutoff, 1e-6f);
+	else
+		gray = 10.0f + 90.0f * r / std::max(mCutoff, 1e-6f);
+
+	// Speckle of +/-10 keeps the two classes apart
+	gray += static_cast<float>(HashPoint(x, y, z, mParams.seed + 2) % 21) - 10.0f;
+	return static_cast<unsigned char>(std::min(std::max(gray, 0.0f), 255.0f));
+}
+
+uint64_t SyntheticStack::GetSliceFileSize() const
+{
+	return 14 + 40 + 4 * PaletteSize(mParams.bitDepth) +
+		   static_cast<uint64_t>(RowStride(mParams.width, mParams.bitDepth)) * mParams.height;
+}
+
+void SyntheticStack::EncodeSlice(const int z, std::vector<unsigned char>& file) const
+{
+	const int width = mParams.width;
+	const int height = mParams.height;
+	const int bitDepth = mParams.bitDepth;
+	const size_t stride = RowStride(width, bitDepth);
+	const int paletteSize = PaletteSize(bitDepth);
+	const uint32_t pixelOffset = 14 + 40 + 4 * paletteSize;
+
+	file.clear();
+	file.reserve(static_cast<size_t>(GetSliceFileSize()));
+
+	// BMFH
+	file.push_back('B');
+	file.push_back('M');
+	Put32(file, static_cast<uint32_t>(GetSliceFileSize()));
+	Put32(file, 0);
+	Put32(file, pixelOffset);
+
+	// BMIH. A positive height means bottom-up rows, a negative one top-down rows.
+	Put32(file, 40);
+	Put32(file, static_cast<uint32_t>(width));
+	Put32(file, static_cast<uint32_t>(mParams.topDown ? -height : height));
+	Put16(file, 1);
+	Put16(file, static_cast<uint32_t>(bitDepth));
+	Put32(file, 0);
+	Put32(file, static_cast<uint32_t>(stride * height));
+	Put32(file, 2835);
+	Put32(file, 2835);
+	Put32(file, static_cast<uint32_t>(paletteSize));
+	Put32(file, 0);
+
+	// Black and white for 1-bit, the gray ramp for 8-bit (BGRA)
+	for (int i = 0; i < paletteSize; ++i)
+	{
+		const unsigned char c = static_cast<unsigned char>((bitDepth == 1) ? i * 255 : i);
+		file.push_back(c);
+		file.push_back(c);
+		file.push_back(c);
+		file.push_back(0);
+	}
+
+	for (int fileRow = 0; fileRow < height; ++fileRow)
+	{
+		const int y = mParams.topDown ? fileRow : height - 1 - fileRow;
+		const size_t rowStart = file.size();
+		file.resize(rowStart + stride, 0);
+		unsigned char* row = &file[rowStart];
+		for (int x = 0; x < width; ++x)
+		{
+			const unsigned char gray = GetGray(x, y, z);
+			switch (bitDepth)
+			{
+			case 1:
+				if (gray >= 128)
+					row[x >> 3] |= static_cast<unsigned char>(0x80 >> (x & 7));
+				break;
+			case 8:
+				row[x] = gray;
+				break;
+			case 24:
+				row[3 * x] = row[3 * x + 1] = row[3 * x + 2] = gray;
+				break;
+			default:
+				row[4 * x] = row[4 * x + 1] = row[4 * x + 2] = gray;
+				row[4 * x + 3] = 0;
+				break;
+			}
+		}
+	}
+}
+
+bool SyntheticStack::WriteSlice(const std::string& filename, const int z) const
+{
+	std::vector<unsigned char> file;
+	EncodeSlice(z, file);
+
+	FILE* fp = fopen(filename.c_str(), "wb");
+	if (!fp)
+		return false;
+	const bool ok = fwrite(file.data(), 1, file.size(), fp) == file.size();
+	return (fclose(fp) == 0) && ok;
+}
+
+bool SyntheticStack::Write(const std::string& folder, std::vector<std::string>* filenames) const
+{
+	for (int z = 0; z < mParams.depth; ++z)
+	{
+		const std::string filename = SliceFilename(folder, z);
+		if (!WriteSlice(filename, z))
+			return false;
+		if (filenames)
+			filenames->push_back(filename);
+	}
+	return true;
+}
+
+std::string SyntheticStack::SliceFilename(const std::string& folder, const int z)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "slice%04d.bmp", z);
+	return folder + "/" + name;
+}
+
+// EOF
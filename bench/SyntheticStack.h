@@ -0,0 +1,83 @@
+///  @file	SyntheticStack.h
+///  @brief	Implements class: SyntheticStack
+///
+///		Generates reproducible BMP stacks that look enough like a CT scan of
+///     trabecular bone to exercise bmp2vox: thin interconnected plates and
+///     struts of bright "bone" in a dark background, with per-pixel speckle.
+///
+///		The structure is the ridge of a two-octave 3D value noise: a voxel is
+///     bone where the noise is close to its midpoint. The ridge cut-off is
+///     picked from a sample of the field so that the requested porosity (the
+///     background fraction) comes out, and featureSize sets the spacing of the
+///     plates in voxels. Bone grays are 140 to 250 and background grays 0 to
+///     110, so any threshold from 110 to 139 recovers the same occupancy.
+///
+///		Slices are written as uncompressed 1, 8 (gray ramp), 24 or 32-bit BMP
+///     files named slice0000.bmp, slice0001.bmp, ... with bottom-up rows, or
+///     top-down rows (a negative height) if topDown is set. The same
+///     parameters and seed always give the same files.
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct SyntheticStackParams
+{
+	SyntheticStackParams()
+	: width(256),
+	  height(256),
+	  depth(32),
+	  bitDepth(24),
+	  porosity(0.75),
+	  featureSize(12.0),
+	  seed(1),
+	  topDown(false)
+	{
+	}
+
+	int width;
+	int height;
+	int depth;
+	int bitDepth;           // 1, 8, 24 or 32
+	double porosity;        // fraction of background voxels, 0 to 1
+	double featureSize;     // spacing of the coarse noise lattice, in voxels
+	uint32_t seed;
+	bool topDown;           // top row first, which BMP::ReadFromFile can't read
+};
+
+class SyntheticStack
+{
+public:
+	explicit SyntheticStack(const SyntheticStackParams& params);
+
+	const SyntheticStackParams& GetParams() const { return mParams; }
+
+	// The gray-level of voxel (x, y, z), with y = 0 the top row as in BMP::operator()
+	unsigned char GetGray(const int x, const int y, const int z) const;
+
+	// The complete BMP file of slice z
+	void EncodeSlice(const int z, std::vector<unsigned char>& file) const;
+	uint64_t GetSliceFileSize() const;
+
+	bool WriteSlice(const std::string& filename, const int z) const;
+
+	// Writes every slice into folder, which must exist. Returns false on the first failure.
+	bool Write(const std::string& folder, std::vector<std::string>* filenames = NULL) const;
+
+	static std::string SliceFilename(const std::string& folder, const int z);
+
+protected:
+	float Field(const float x, const float y, const float z) const;
+	float Ridge(const int x, const int y, const int z) const;
+
+	SyntheticStackParams mParams;
+	float mCutoff;      // ridge values above this are bone
+};
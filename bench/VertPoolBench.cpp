@@ -0,0 +1,148 @@
+///  @file	VertPoolBench.cpp
+///  @brief	Microbenchmark: VertPool (std::map) vs HashVertPool (open addressing)
+///
+///		Welds the corners of an n x n x n block of cubes, each corner slightly
+///     jittered as in a float mesh, so every lattice point is referenced by
+///     up to 8 cubes. Times AddVertRef, the bulk AddVertRefs, and removing
+///     every reference again, and checks that both pools hand out the same
+///     IDs and pooled positions.
+///
+///		Usage: vertpool_bench [n = 64] [repeats = 3]
+///
+///		Copyright 2026 Greg Ruthenbeck
+///
+///  @author	Greg Ruthenbeck
+///  @version	0.1
+///  Originally created:   October 2026
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "VertPool.h"
+#include "HashVertPool.h"
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	double SecondsSince(const Clock::time_point& start)
+	{
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	// Small deterministic jitter in [-0.05, 0.05)
+	float Jitter(uint32_t& state)
+	{
+		state = state * 1664525u + 1013904223u;
+		return (static_cast<float>(state >> 8) / 16777216.0f - 0.5f) * 0.1f;
+	}
+
+	std::vector<SIMPLE_VERTEX> MakeCubeCorners(const int n)
+	{
+		std::vector<SIMPLE_VERTEX> verts;
+		verts.reserve(static_cast<size_t>(n) * n * n * 8);
+		uint32_t state = 12345;
+		for (int z = 0; z < n; ++z)
+			for (int y = 0; y < n; ++y)
+				for (int x = 0; x < n; ++x)
+					for (int c = 0; c < 8; ++c)
+					{
+						const Vec3 corner(static_cast<float>(x + (c & 1)),
+										  static_cast<float>(y + ((c >> 1) & 1)),
+										  static_cast<float>(z + ((c >> 2) & 1)));
+						verts.push_back(SIMPLE_VERTEX(corner + Vec3(Jitter(state), Jitter(state), Jitter(state))));
+					}
+		return verts;
+	}
+
+	bool SamePositions(const std::vector<SIMPLE_VERTEX>& a, const std::vector<SIMPLE_VERTEX>& b)
+	{
+		if (a.size() != b.size())
+			return false;
+		for (size_t i = 0; i < a.size(); ++i)
+			if (memcmp(&a[i].pos, &b[i].pos, sizeof(Vec3)) != 0)
+				return false;
+		return true;
+	}
+
+	void Report(const char* name, const double seconds, const size_t refs)
+	{
+		printf("  %-28s %9.3f ms  %8.1f Mrefs/s\n", name, seconds * 1e3, refs / seconds / 1e6);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int n = (argc > 1) ? atoi(argv[1]) : 64;
+	const int repeats = (argc > 2) ? atoi(argv[2]) : 3;
+	if (n <= 0 || repeats <= 0)
+	{
+		printf("Usage: vertpool_bench [n = 64] [repeats = 3]\n");
+		return 1;
+	}
+
+	// Cells of width 1 centred on the lattice points, so the jittered corners of a point share a key
+	const KeyType dim = static_cast<KeyType>(n) + 2;
+	const Vec3 minVert(0.5f, 0.5f, 0.5f);
+	const Vec3 span(static_cast<float>(dim), static_cast<float>(dim), static_cast<float>(dim));
+
+	const std::vector<SIMPLE_VERTEX> verts = MakeCubeCorners(n);
+	const size_t refs = verts.size();
+	printf("%d^3 cubes, %zu vert refs, %zu unique verts, best of %d\n",
+		   n, refs, static_cast<size_t>(n + 1) * (n + 1) * (n + 1), repeats);
+
+	double mapAdd = 1e30, mapRemove = 1e30, hashAdd = 1e30, hashBulk = 1e30, hashRemove = 1e30;
+	bool same = true;
+	std::vector<VertIdType> mapIds(refs), hashIds(refs), bulkIds(refs);
+	for (int r = 0; r < repeats; ++r)
+	{
+		{
+			VertPool<SIMPLE_VERTEX> pool(dim, minVert, span);
+			Clock::time_point start = Clock::now();
+			for (size_t i = 0; i < refs; ++i)
+				mapIds[i] = pool.AddVertRef(verts[i]);
+			mapAdd = std::min(mapAdd, SecondsSince(start));
+
+			HashVertPool<SIMPLE_VERTEX> hashPool(dim, minVert, span);
+			start = Clock::now();
+			for (size_t i = 0; i < refs; ++i)
+				hashIds[i] = hashPool.AddVertRef(verts[i]);
+			hashAdd = std::min(hashAdd, SecondsSince(start));
+
+			same &= (mapIds == hashIds) && SamePositions(pool.GetPooledVerts(), hashPool.GetPooledVerts());
+
+			start = Clock::now();
+			for (size_t i = 0; i < refs; ++i)
+				pool.RemoveVertRef(verts[i].pos);
+			mapRemove = std::min(mapRemove, SecondsSince(start));
+
+			start = Clock::now();
+			for (size_t i = 0; i < refs; ++i)
+				hashPool.RemoveVertRef(verts[i].pos);
+			hashRemove = std::min(hashRemove, SecondsSince(start));
+
+			// Everything was removed, so both pools re-use IDs from the same free list now
+			for (size_t i = 0; i < refs / 8; ++i)
+				same &= (pool.AddVertRef(verts[i]) == hashPool.AddVertRef(verts[i]));
+		}
+		{
+			HashVertPool<SIMPLE_VERTEX> hashPool(dim, minVert, span);
+			const Clock::time_point start = Clock::now();
+			hashPool.AddVertRefs(verts.data(), refs, bulkIds.data());
+			hashBulk = std::min(hashBulk, SecondsSince(start));
+			same &= (bulkIds == mapIds);
+		}
+	}
+
+	Report("VertPool AddVertRef", mapAdd, refs);
+	Report("HashVertPool AddVertRef", hashAdd, refs);
+	Report("HashVertPool AddVertRefs", hashBulk, refs);
+	Report("VertPool RemoveVertRef", mapRemove, refs);
+	Report("HashVertPool RemoveVertRef", hashRemove, refs);
+	printf("Pools agree: %s\n", same ? "yes" : "NO");
+	return same ? 0 : 1;
+}
+
+// EOF
@@ -131,12 +131,12 @@ RGBApixel BMP::GetPixel( int i, int j ) const
        << "                 Truncating request to fit in the range [0,"
        << Width-1 << "] x [0," << Height-1 << "]." << endl;
  }	
- return Pixels[i][j];
+ return Pixels[j*Width+i];
 }
 
 bool BMP::SetPixel( int i, int j, RGBApixel NewPixel )
 {
- Pixels[i][j] = NewPixel;
+ Pixels[j*Width+i] = NewPixel;
  return true;
 }
 
@@ -225,8 +225,7 @@ BMP::BMP()
  Width = 1;
  Height = 1;
  BitDepth = 24;
- Pixels = new RGBApixel* [Width];
- Pixels[0] = new RGBApixel [Height];
+ Pixels = new RGBApixel [Width*Height];
  Colors = NULL;
  
  XPelsPerMeter = 0;
@@ -246,8 +245,7 @@ BMP::BMP( BMP& Input )
  Width = 1;
  Height = 1;
  BitDepth = 24;
- Pixels = new RGBApixel* [Width];
- Pixels[0] = new RGBApixel [Height];
+ Pixels = new RGBApixel [Width*Height];
  Colors = NULL; 
  XPelsPerMeter = 0;
  YPelsPerMeter = 0;
@@ -286,17 +284,14 @@ BMP::BMP( BMP& Input )
  {
   for( int i=0; i < Width ; i++ )
   {
-   Pixels[i][j] = *Input(i,j);
-//   Pixels[i][j] = Input.GetPixel(i,j); // *Input(i,j);
+   Pixels[j*Width+i] = *Input(i,j);
+//   Pixels[j*Width+i] = Input.GetPixel(i,j); // *Input(i,j);
   }
  }
 }
 
 BMP::~BMP()
 {
- int i;
- for(i=0;i<Width;i++)
- { delete [] Pixels[i]; }
  delete [] Pixels;
  if( Colors )
  { delete [] Colors; }
@@ -307,6 +302,12 @@ BMP::~BMP()
  { delete [] MetaData2; }
 } 
 
+RGBApixel* BMP::Row( int j )
+{ return Pixels + j*Width; }
+
+const RGBApixel* BMP::Row( int j ) const
+{ return Pixels + j*Width; }
+
 RGBApixel* BMP::operator()(int i, int j)
 {
  using namespace std;
@@ -325,7 +326,7 @@ RGBApixel* BMP::operator()(int i, int j)
        << "                 Truncating request to fit in the range [0,"
        << Width-1 << "] x [0," << Height-1 << "]." << endl;
  }	
- return &(Pixels[i][j]);
+ return &(Pixels[j*Width+i]);
 }
 
 // int BMP::TellBitDepth( void ) const
@@ -394,29 +395,26 @@ bool BMP::SetSize(int NewWidth , int NewHeight )
   return false;
  }
 
- int i,j; 
+ int i; 
 
- for(i=0;i<Width;i++)
- { delete [] Pixels[i]; }
- delete [] Pixels;
+ // Pixels are one contiguous row-major block. Only reallocate when
+ // the pixel count changes.
+ if( NewWidth*NewHeight != Width*Height )
+ {
+  delete [] Pixels;
+  Pixels = new RGBApixel [ NewWidth*NewHeight ];
+ }
 
  Width = NewWidth;
  Height = NewHeight;
- Pixels = new RGBApixel* [ Width ]; 
  
- for(i=0; i<Width; i++)
- { Pixels[i] = new RGBApixel [ Height ]; }
- 
- for( i=0 ; i < Width ; i++)
- {
-  for( j=0 ; j < Height ; j++ )
-  {
-   Pixels[i][j].Red = 255; 
-   Pixels[i][j].Green = 255; 
-   Pixels[i][j].Blue = 255; 
-   Pixels[i][j].Alpha = 0;    
-  }
- }
+ RGBApixel White;
+ White.Red = 255; 
+ White.Green = 255; 
+ White.Blue = 255; 
+ White.Alpha = 0;    
+ for( i=0 ; i < Width*Height ; i++)
+ { Pixels[i] = White; }
 
  return true; 
 }
@@ -637,9 +635,9 @@ bool BMP::WriteToFile( const char* FileName )
    {
     ebmpWORD TempWORD;
 	
-	ebmpWORD RedWORD = (ebmpWORD) ((Pixels[i][j]).Red / 8);
-	ebmpWORD GreenWORD = (ebmpWORD) ((Pixels[i][j]).Green / 4);
-	ebmpWORD BlueWORD = (ebmpWORD) ((Pixels[i][j]).Blue / 8);
+	ebmpWORD RedWORD = (ebmpWORD) ((Pixels[j*Width+i]).Red / 8);
+	ebmpWORD GreenWORD = (ebmpWORD) ((Pixels[j*Width+i]).Green / 4);
+	ebmpWORD BlueWORD = (ebmpWORD) ((Pixels[j*Width+i]).Blue / 8);
 	
     TempWORD = (RedWORD<<11) + (GreenWORD<<5) + BlueWORD;
 	if( IsBigEndian() )
@@ -1062,9 +1060,9 @@ bool BMP::ReadFromFile( const char* FileName )
     ebmpBYTE GreenBYTE = (ebmpBYTE) 8*(Green>>GreenShift);
     ebmpBYTE RedBYTE = (ebmpBYTE) 8*(Red>>RedShift);
 		
-	(Pixels[i][j]).Red = RedBYTE;
-	(Pixels[i][j]).Green = GreenBYTE;
-	(Pixels[i][j]).Blue = BlueBYTE;
+	(Pixels[j*Width+i]).Red = RedBYTE;
+	(Pixels[j*Width+i]).Green = GreenBYTE;
+	(Pixels[j*Width+i]).Blue = BlueBYTE;
 	
 	i++;
    }
@@ -1560,11 +1558,10 @@ bool CreateGrayscaleColorTable( BMP& InputImage )
 
 bool BMP::Read32bitRow( ebmpBYTE* Buffer, int BufferSize, int Row )
 { 
- int i;
  if( Width*4 > BufferSize )
  { return false; }
- for( i=0 ; i < Width ; i++ )
- { memcpy( (char*) &(Pixels[i][Row]), (char*) Buffer+4*i, 4 ); }
+ // rows are contiguous, so a 32-bit row is a single copy
+ memcpy( (char*) &(Pixels[Row*Width]), (char*) Buffer, 4*Width );
  return true;
 }
 
@@ -1574,7 +1571,7 @@ bool BMP::Read24bitRow( ebmpBYTE* Buffer, int BufferSize, int Row )
  if( Width*3 > BufferSize )
  { return false; }
  for( i=0 ; i < Width ; i++ )
- { memcpy( (char*) &(Pixels[i][Row]), Buffer+3*i, 3 ); }
+ { memcpy( (char*) &(Pixels[Row*Width+i]), Buffer+3*i, 3 ); }
  return true;
 }
 
@@ -1586,7 +1583,7 @@ bool BMP::Read8bitRow(  ebmpBYTE* Buffer, int BufferSize, int Row )
  for( i=0 ; i < Width ; i++ )
  {
   int Index = Buffer[i];
-  *( this->operator()(i,Row) )= GetColor(Index); 
+  Pixels[Row*Width+i] = Colors[Index]; 
  }
  return true;
 }
@@ -1607,7 +1604,7 @@ bool BMP::Read4bitRow(  ebmpBYTE* Buffer, int BufferSize, int Row )
   while( j < 2 && i < Width )
   {
    int Index = (int) ( (Buffer[k]&Masks[j]) >> Shifts[j]);
-   *( this->operator()(i,Row) )= GetColor(Index); 
+   Pixels[Row*Width+i] = Colors[Index]; 
    i++; j++;   
   }
   k++;
@@ -1631,7 +1628,7 @@ bool BMP::Read1bitRow(  ebmpBYTE* Buffer, int BufferSize, int Row )
   while( j < 8 && i < Width )
   {
    int Index = (int) ( (Buffer[k]&Masks[j]) >> Shifts[j]);
-   *( this->operator()(i,Row) )= GetColor(Index); 
+   Pixels[Row*Width+i] = Colors[Index]; 
    i++; j++;   
   }
   k++;
@@ -1641,11 +1638,9 @@ bool BMP::Read1bitRow(  ebmpBYTE* Buffer, int BufferSize, int Row )
 
 bool BMP::Write32bitRow( ebmpBYTE* Buffer, int BufferSize, int Row )
 { 
- int i;
  if( Width*4 > BufferSize )
  { return false; }
- for( i=0 ; i < Width ; i++ )
- { memcpy( (char*) Buffer+4*i, (char*) &(Pixels[i][Row]), 4 ); }
+ memcpy( (char*) Buffer, (char*) &(Pixels[Row*Width]), 4*Width );
  return true;
 }
 
@@ -1655,7 +1650,7 @@ bool BMP::Write24bitRow( ebmpBYTE* Buffer, int BufferSize, int Row )
  if( Width*3 > BufferSize )
  { return false; }
  for( i=0 ; i < Width ; i++ )
- { memcpy( (char*) Buffer+3*i,  (char*) &(Pixels[i][Row]), 3 ); }
+ { memcpy( (char*) Buffer+3*i,  (char*) &(Pixels[Row*Width+i]), 3 ); }
  return true;
 }
 
@@ -1665,7 +1660,7 @@ bool BMP::Write8bitRow(  ebmpBYTE* Buffer, int BufferSize, int Row )
  if( Width > BufferSize )
  { return false; }
  for( i=0 ; i < Width ; i++ )
- { Buffer[i] = FindClosestColor( Pixels[i][Row] ); }
+ { Buffer[i] = FindClosestColor( Pixels[Row*Width+i] ); }
  return true;
 }
 
@@ -1684,7 +1679,7 @@ bool BMP::Write4bitRow(  ebmpBYTE* Buffer, int BufferSize, int Row )
   int Index = 0;
   while( j < 2 && i < Width )
   {
-   Index += ( PositionWeights[j]* (int) FindClosestColor( Pixels[i][Row] ) ); 
+   Index += ( PositionWeights[j]* (int) FindClosestColor( Pixels[Row*Width+i] ) ); 
    i++; j++;   
   }
   Buffer[k] = (ebmpBYTE) Index;
@@ -1708,7 +1703,7 @@ bool BMP::Write1bitRow(  ebmpBYTE* Buffer, int BufferSize, int Row )
   int Index = 0;
   while( j < 8 && i < Width )
   {
-   Index += ( PositionWeights[j]* (int) FindClosestColor( Pixels[i][Row] ) ); 
+   Index += ( PositionWeights[j]* (int) FindClosestColor( Pixels[Row*Width+i] ) ); 
    i++; j++;   
   }
   Buffer[k] = (ebmpBYTE) Index;
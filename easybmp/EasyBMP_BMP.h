@@ -30,7 +30,7 @@ class BMP
  int BitDepth;
  int Width;
  int Height;
- RGBApixel** Pixels;
+ RGBApixel* Pixels; // Width*Height pixels, row-major (row j starts at Pixels[j*Width])
  RGBApixel* Colors;
  int XPelsPerMeter;
  int YPelsPerMeter;
@@ -68,6 +68,10 @@ class BMP
  BMP( BMP& Input );
  ~BMP();
  RGBApixel* operator()(int i,int j);
+ // Unchecked access to the Width contiguous pixels of row j. Unlike
+ // operator(), j is not clamped, so it must be in [0,Height-1].
+ RGBApixel* Row( int j );
+ const RGBApixel* Row( int j ) const;
  
  RGBApixel GetPixel( int i, int j ) const;
  bool SetPixel( int i, int j, RGBApixel NewPixel );
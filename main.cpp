@@ -15,11 +15,29 @@ using namespace std;
 
 #include <iostream>
 #include <iomanip>
+#include <memory>
+#include <algorithm>
 #include <boost/program_options.hpp>
 #include <boost/program_options/parsers.hpp>
 #include <boost/filesystem.hpp>
-#include "easybmp/easybmp.h"
+#include "easybmp/EasyBMP.h"
 #include "VertPool.h"
+#include "MappedBitmap.h"
+#include "LatticeNodePool.h"
+#include "BoxGroups.h"
+#include "SlicePipeline.h"
+#include "OccupancyCache.h"
+#include "OrderedWriter.h"
+#include "MeshFormat.h"
+#include "RunStats.h"
+#include "TraceRecorder.h"
+#include "Checkpoint.h"
+#include "SliceCoarsener.h"
+#include "ComponentFilter.h"
+#include "OctreeMesher.h"
+#include "SurfaceMesher.h"
+#include "MeshRenumberer.h"
+#include "DomainPartitioner.h"
 
 namespace po = boost::program_options;
 namespace fs = boost::filesystem;
@@ -36,11 +54,6 @@ const float PixColourAsFlt(const RGBApixel* const pix)
 			static_cast<float>(pix->Blue) /255.0f) / 3.0f;
 }
 
-const short PixColourAsShort(const RGBApixel* const pix)
-{
-	return (pix->Red + pix->Green + pix->Blue) / 3;
-}
-
 const Vec3 IndexToVert(const int x, const int y, const int z)
 {
 	return Vec3(static_cast<float>(x),
@@ -48,21 +61,6 @@ const Vec3 IndexToVert(const int x, const int y, const int z)
 				static_cast<float>(z));
 }
 
-struct AABox
-{
-	Vec3 minima;
-	Vec3 maxima;
-	bool inside;
-};
-
-bool IsInAABox(const Vec3& p, const AABox& box)
-{
-	const bool i = (p.x > box.minima.x && p.x < box.maxima.x &&
-					p.y > box.minima.y && p.y < box.maxima.y &&
-					p.z > box.minima.z && p.z < box.maxima.z);
-	return (box.inside ? i : !i);
-}
-
 int main(int ac, char** av)
 {
 	// Declare the supported options.
@@ -70,12 +68,31 @@ int main(int ac, char** av)
 	desc.add_options()
 		("help", "produce help message")
 		("s", po::bool_switch(), "silent")
-		("t", po::value<short>()->default_value(128), "threshold gray-level [0, 255]")
+		("t", po::value<vector<short> >()->multitoken()->default_value(vector<short>(1, 128), "128"), "threshold gray-level [0, 255]. Several (e.g. --t 100 110 120) mesh each from a single pass over the bitmaps")
 		("n", po::bool_switch(), "invert (negate) the image")
 		("i", po::value<string>()->default_value("."), "input folder (sorts contained BMPs)")
 		("o", po::value<string>()->default_value("nodes.txt"),   "output file for node data")
 		("O", po::value<string>()->default_value("indices.txt"), "output file for indices data")
 		("b", po::value<string>()->default_value("boxes.txt"), "optional input file that contains axis-aligned boxes")
+		("c", po::value<string>()->default_value("constraints.txt"), "output file for hanging-node constraints, with --adaptive")
+		("partitions", po::value<int>()->default_value(0), "split the lattice into this many partitions for a distributed solver, by recursive coordinate bisection balanced by element count. Each is meshed like a box of --b, into its own node and element files, with a map of the nodes it shares to --m")
+		("m", po::value<string>()->default_value("interface.txt"), "output file for each partition's interface node map, with --partitions: the node, its global ID, and the partition it is shared with. IDs are from 1 with --format ascii and from 0 with binary")
+		("adaptive", po::value<int>()->default_value(0), "merge fully-solid blocks of up to 2^n x 2^n x 2^n voxels into single elements of a balanced octree, for n [1, 6], writing its hanging nodes to --c (0 for the uniform lattice)")
+		("surface", po::value<string>(), "write only the boundary of the voxel set, as faces rather than hexahedra: quad or tri")
+		("keep-largest", po::bool_switch(), "mesh only the largest connected component of the voxels (voxels that share a face are connected)")
+		("min-component-size", po::value<uint64_t>()->default_value(0), "mesh only the connected components of at least this many voxels (of the lattice, with --coarsen)")
+		("coarsen", po::value<int>()->default_value(1), "bin k x k x k voxels into one, for a lattice k times coarser (in the same coordinates)")
+		("coarsen-fraction", po::value<double>()->default_value(0.5), "with --coarsen, a bin is foreground if more than this fraction of its voxels are [0, 1). 0.5 is a majority")
+		("threads", po::value<int>()->default_value(1), "number of threads used to read and threshold bitmaps ahead of the mesher")
+		("format", po::value<string>()->default_value("ascii"), "output format for nodes and indices: ascii or binary")
+		("renumber", po::value<string>(), "renumber nodes and elements once meshed: morton or hilbert, along a space-filling curve, for locality (this increases the bandwidth, and usually the profile), or rcm, by reverse Cuthill-McKee, which reduces them for banded and skyline solvers. Reports the bandwidth, profile and median element span before and after")
+		("renumber-memory", po::value<int>()->default_value(512), "with --renumber, megabytes each sort holds in memory. Larger meshes are sorted on disk")
+		("cache-dir", po::value<string>(), "folder for the thresholded (occupancy) cache of the stack (default: the folder of the nodes output file, --o)")
+		("no-cache", po::bool_switch(), "neither read nor write the occupancy cache")
+		("stats", po::value<string>()->implicit_value("-"), "write a JSON summary of stage times, rates, node pools, output sizes and peak memory to this file (stdout if no file is given)")
+		("checkpoint-every", po::value<int>()->default_value(100), "save a checkpoint every this many slices, so an interrupted run can be resumed (0 for none)")
+		("resume", po::bool_switch(), "continue an interrupted run from its last checkpoint (same inputs and options)")
+		("trace", po::value<string>(), "write a timeline of every slice and stage, on every thread, to this file (Chrome trace_event JSON)")
 	;
 
 	po::variables_map vm;
@@ -95,6 +112,15 @@ int main(int ac, char** av)
 	const bool silentArg = vm["s"].as<bool>();
 	const bool negateArg = vm["n"].as<bool>();
 
+	// Stage timers are no-ops unless --stats or --trace is given
+	unique_ptr<TraceRecorder> trace(vm.count("trace") ? new TraceRecorder : NULL);
+	unique_ptr<RunStats> stats((vm.count("stats") || trace) ? new RunStats : NULL);
+	if (trace)
+	{
+		stats->SetTracer(trace.get());
+		trace->NameThread("main");
+	}
+
 	//if (vm.count("input-folder"))
 	//{
 	//	if (!silentArg)
@@ -155,6 +181,12 @@ int main(int ac, char** av)
 		return 1;
 	}
 
+	sort(bitmapFilenames.begin(), bitmapFilenames.end());
+
+	vector<string> sliceFilenames;
+	for (auto fname = bitmapFilenames.begin(); fname != bitmapFilenames.end(); ++fname)
+		sliceFilenames.push_back(fname->generic_string());
+
 	const string outputFilenameNodes = vm["o"].as<string>();
 	if (fs::exists(fs::path(outputFilenameNodes.c_str())))
 	{
@@ -198,26 +230,78 @@ int main(int ac, char** av)
 		groupBoxes.push_back(box);
 	}
 
-	const int numGroups = groupBoxes.size();
-	vector<ofstream> fileNodes, fileIndices;
-	for (int gi = 0; gi < numGroups; ++gi)
+	// A sweep of several thresholds meshes each of them, into its own files, from the same slices
+	const vector<short> thresholds = vm["t"].as<vector<short> >();
+	const int numThresholds = static_cast<int>(thresholds.size());
+	const bool sweep = numThresholds > 1;
+	for (int ti = 1; ti < numThresholds; ++ti)
 	{
-		stringstream nodesNameSS, indicesNameSS;
-		nodesNameSS   << outputFilenameNodes << gi << ".txt" << ends;
-		indicesNameSS << outputFilenameIndices << gi << ".txt" << ends;
-		fileNodes.push_back(ofstream(nodesNameSS.str().c_str(),   ios::out));
-		fileIndices.push_back(ofstream(indicesNameSS.str().c_str(), ios::out));
-
-		if (!fileNodes.back().good() && !silentArg)
+		if (find(thresholds.begin(), thresholds.begin() + ti, thresholds[ti]) != thresholds.begin() + ti)
 		{
-			cout << "Failed to open nodes output file." << endl;
+			cout << "Error. Threshold " << thresholds[ti] << " is given more than once. Use --help." << endl;
 			return 1;
 		}
+	}
+	const int numThreads = vm["threads"].as<int>();
 
-		if (!fileIndices.back().good() && !silentArg)
+	// A coarsened lattice bins coarsen^3 voxels into one. Its nodes are scaled back to voxel units, and
+	// boxes are given in voxel units, so both line up with the full-resolution lattice.
+	const int coarsen = vm["coarsen"].as<int>();
+	const double coarsenFraction = vm["coarsen-fraction"].as<double>();
+	if (coarsen < 1 || coarsenFraction < 0.0 || coarsenFraction >= 1.0)
+	{
+		cout << "Error. --coarsen must be at least 1, and --coarsen-fraction in [0, 1). Use --help." << endl;
+		return 1;
+	}
+	const int adaptiveLevel = vm["adaptive"].as<int>();
+	const bool adaptive = adaptiveLevel > 0;
+	if (adaptiveLevel < 0 || adaptiveLevel > OctreeMesher::kMaxLevel)
+	{
+		cout << "Error. --adaptive must be in [0, " << OctreeMesher::kMaxLevel << "]. Use --help." << endl;
+		return 1;
+	}
+	const bool surface = vm.count("surface") != 0;
+	const bool surfaceTriangles = surface && vm["surface"].as<string>() == "tri";
+	if (surface && !surfaceTriangles && vm["surface"].as<string>() != "quad")
+	{
+		cout << "Unknown surface type \"" << vm["surface"].as<string>() << "\". Use --help." << endl;
+		return 1;
+	}
+	if (surface && adaptive)
+	{
+		cout << "Error. --surface and --adaptive can't be used together. Use --help." << endl;
+		return 1;
+	}
+	// Components are found over the whole of each threshold's stack, before it is split into boxes
+	const bool keepLargest = vm["keep-largest"].as<bool>();
+	const uint64_t minComponentSize = vm["min-component-size"].as<uint64_t>();
+	const bool filterComponents = keepLargest || minComponentSize > 0;
+	for (auto box = groupBoxes.begin(); box != groupBoxes.end() && coarsen > 1; ++box)
+	{
+		const float factor = static_cast<float>(coarsen);
+		box->minima = Vec3(box->minima.x / factor, box->minima.y / factor, box->minima.z / factor);
+		box->maxima = Vec3(box->maxima.x / factor, box->maxima.y / factor, box->maxima.z / factor);
+	}
+
+	// The stack thresholded by an earlier run, if these bitmaps haven't changed since. A sweep
+	// uses the cache only if every one of its thresholds is cached.
+	const bool useCache = !vm["no-cache"].as<bool>();
+	const int depth = static_cast<int>(sliceFilenames.size());
+	const uint64_t fingerprint = OccupancyCacheFingerprint(sliceFilenames);   // also identifies checkpoints
+	vector<string> cacheFilenames(numThresholds);
+	vector<unique_ptr<OccupancyCacheReader> > cacheReaders;
+	bool cacheHit = useCache;
+
+	// Next to the output rather than the input, which may be read-only or shared
+	const string outputFolder = fs::path(outputFilenameNodes).parent_path().generic_string();
+	const string cacheDir = vm.count("cache-dir") ? vm["cache-dir"].as<string>() : (outputFolder.empty() ? "." : outputFolder);
+	for (int ti = 0; ti < numThresholds; ++ti)
+	{
+		cacheReaders.push_back(unique_ptr<OccupancyCacheReader>(new OccupancyCacheReader));
+		if (useCache)
 		{
-			cout << "Failed to open indices output file." << endl;
-			return 1;
+			cacheFilenames[ti] = OccupancyCachePath(cacheDir, inputFolderName, thresholds[ti], negateArg);
+			cacheHit = cacheHit && cacheReaders[ti]->Open(cacheFilenames[ti], fingerprint, depth, thresholds[ti], negateArg);
 		}
 	}
 
@@ -225,109 +309,902 @@ int main(int ac, char** av)
 	// Hack: Assume all bitmaps in this folder are part of the sequence (and are all the same dimensions)
 	int testWidth = 0;
 	int testHeight = 0;
+	if (cacheHit)
 	{
-		BMP bmp;
-		bmp.ReadFromFile( bitmapFilenames[0].generic_string().c_str() );
-		testWidth = bmp.TellWidth();
-		testHeight = bmp.TellHeight();
+		testWidth = cacheReaders[0]->GetWidth();
+		testHeight = cacheReaders[0]->GetHeight();
+		if (!silentArg)
+			for (int ti = 0; ti < numThresholds; ++ti)
+				cout << "Using occupancy cache \"" << cacheFilenames[ti] << "\"" << endl;
+	}
+	else
+	{
+		// Probe through the mapping first, as the slices are read: BMP::ReadFromFile can't read top-down files
+		MappedBitmap mapped;
+		if (mapped.Open(bitmapFilenames[0].generic_string().c_str()))
+		{
+			testWidth = mapped.GetWidth();
+			testHeight = mapped.GetHeight();
+		}
+		else
+		{
+			BMP bmp;
+			bmp.ReadFromFile( bitmapFilenames[0].generic_string().c_str() );
+			testWidth = bmp.TellWidth();
+			testHeight = bmp.TellHeight();
+		}
 	}
 
-	vector<VertPool<SIMPLE_VERTEX> > vertPools;
-	for (int i = 0; i < groupBoxes.size(); ++i)
+	const int meshWidth = (testWidth + coarsen - 1) / coarsen;
+	const int meshHeight = (testHeight + coarsen - 1) / coarsen;
+	const int meshDepth = (depth + coarsen - 1) / coarsen;
+
+	unique_ptr<MeshFormat> outputFormat(CreateMeshFormat(vm["format"].as<string>(), meshWidth, meshHeight,
+														 static_cast<uint32_t>(meshDepth)));
+	if (!outputFormat)
 	{
-		// HACK: I have changed the keyDim (1st param of ctor) to be the image width to correct a problem with floating-point node indices in the output (28/Aug/2014).
-		// The KeyDim should be as large as possible to ensure that the map used by the VertPool has multiple entries per keyed-block. Otherwise there
-		// is no benefit for using the map<>. TODO: Investigate and fix so that map<> behaves correctly and performance is maximized for large datasets.
-		vertPools.push_back(VertPool<SIMPLE_VERTEX>((int)((float)testWidth*1.2f), Vec3(-1.0f, -1.0f, -1.0f), 
-													Vec3(static_cast<float>(testWidth)  + 2.0f, 
-														 static_cast<float>(testHeight) + 2.0f, 
-														 static_cast<float>(bitmapFilenames.size()) + 2.0f)));
+		cout << "Unknown output format \"" << vm["format"].as<string>() << "\". Use --help." << endl;
+		return 1;
 	}
 
-	sort(bitmapFilenames.begin(), bitmapFilenames.end());
+	// A renumbered mesh is written as binary first, to files named after the output files, and renumbered
+	// into the output format once the stack is meshed
+	const string renumberArg = vm.count("renumber") ? vm["renumber"].as<string>() : "";
+	const bool renumber = !renumberArg.empty();
+	if (renumber && renumberArg != "morton" && renumberArg != "hilbert" && renumberArg != "rcm")
+	{
+		cout << "Unknown renumbering \"" << renumberArg << "\". Use --help." << endl;
+		return 1;
+	}
+	if (renumber && vm["renumber-memory"].as<int>() < 1)
+	{
+		cout << "Error. --renumber-memory must be at least 1. Use --help." << endl;
+		return 1;
+	}
+	unique_ptr<MeshFormat> meshFormat(CreateMeshFormat(renumber ? "binary" : vm["format"].as<string>(), meshWidth, meshHeight,
+													   static_cast<uint32_t>(meshDepth)));
 
-	const short threshold = vm["t"].as<short>();
+	// With --partitions, the groups are the partitions' boxes instead of those of a --b file. Their interface
+	// maps hold the node IDs as the run writes them, so they aren't renumbered.
+	const int numPartitions = vm["partitions"].as<int>();
+	const bool partition = numPartitions > 0;
+	if (numPartitions < 0)
+	{
+		cout << "Error. --partitions must be at least 1. Use --help." << endl;
+		return 1;
+	}
+	if (partition && (adaptive || surface || renumber || sweep || !vm["b"].defaulted()))
+	{
+		cout << "Error. --partitions can't be used with --adaptive, --surface, --renumber, --b or more than one threshold. Use --help." << endl;
+		return 1;
+	}
+	const bool resumeArg = vm["resume"].as<bool>();
+	if (resumeArg && (adaptive || surface || partition))
+	{
+		cout << "Error. --adaptive, --surface and --partitions runs can't be resumed. Use --help." << endl;
+		return 1;
+	}
 
-	unsigned int voxelCount = 0;
-	unsigned int sliceCount = 0;
-	const string sep = ",\t";
-	for (auto str = bitmapFilenames.begin(); str != bitmapFilenames.end(); ++str, ++sliceCount)
+	// Bitmaps are read and thresholded ahead of time on worker threads (when numThreads > 1). Slices
+	// come back in stack order, so node numbering and element ordering below are the same as a serial run.
+	// On a cache miss the thresholded slices are also written to the cache for the next run (unless
+	// resuming, as the slices before the checkpoint aren't read again).
+	unique_ptr<SlicePipeline> pipeline;
+	vector<unique_ptr<OccupancyCacheWriter> > cacheWriters;
+	if (!cacheHit)
 	{
-		if (!silentArg && sliceCount % 100 == 99)
-			cout << "Processing slice " << (sliceCount+1) << " of " << bitmapFilenames.size() << endl;
+		pipeline.reset(new SlicePipeline(sliceFilenames, testWidth, testHeight, thresholds, negateArg, numThreads));
+		pipeline->SetStats(stats.get());
+		for (int ti = 0; ti < numThresholds && useCache && !resumeArg; ++ti)
+		{
+			cacheWriters.push_back(unique_ptr<OccupancyCacheWriter>(new OccupancyCacheWriter));
+			if (!cacheWriters.back()->Open(cacheFilenames[ti], fingerprint, testWidth, testHeight, depth, thresholds[ti], negateArg))
+				cout << "Warning. Unable to create occupancy cache \"" << cacheFilenames[ti] << "\". Use --cache-dir or --no-cache." << endl;
+		}
+	}
+	OrderedWriter writer(numThreads > 1);
+	writer.SetStats(stats.get());
+
+	// Waiting on the pipeline, or copying from the cache. Either way, one slice per threshold, and on a
+	// cache miss each of them also goes to its threshold's cache.
+	auto readSlices = [&](vector<OccupancySlice>& slices) {
+		bool read = true;
+		{
+			StageTimer timer(stats.get(), pipeline ? RunStats::kSliceWait : RunStats::kCacheRead);
+			if (pipeline)
+				read = pipeline->Next(slices);
+			for (int ti = 0; ti < numThresholds && read && !pipeline; ++ti)
+				read = cacheReaders[ti]->Next(slices[ti]);
+		}
+		for (size_t ti = 0; ti < cacheWriters.size() && read; ++ti)
+		{
+			if (cacheWriters[ti]->IsOpen())
+			{
+				StageTimer timer(stats.get(), RunStats::kCacheWrite, slices[ti].z);
+				cacheWriters[ti]->Write(slices[ti]);
+			}
+		}
+		return read;
+	};
+
+	// Every threshold's slice comes from the same bitmap, so they share a status. Errors are reported
+	// by the meshing pass, not again by a pass before it.
+	bool prePass = false;
+	auto reportUnreadable = [&](const OccupancySlice& slice) {
+		if (prePass)
+			return slice.status != OccupancySlice::kOk;
+		if (slice.status == OccupancySlice::kReadError)
+		{
+			cout << "Error reading bitmap. Filename = \"" << bitmapFilenames[slice.z] << "\"" << endl;
+			return true;
+		}
+		if (slice.status == OccupancySlice::kSizeMismatch)
+		{
+			cout << "Error. Bitmap dimensions differ from the first bitmap in the sequence. Filename = \"" << bitmapFilenames[slice.z] << "\"" << endl;
+			return true;
+		}
+		return false;
+	};
+
+	// With --coarsen, each slice of the lattice is binned from the next coarsen slices of the stack
+	// (a bitmap that can't be read is binned as background)
+	vector<unique_ptr<SliceCoarsener> > coarseners;
+	for (int ti = 0; ti < numThresholds && coarsen > 1; ++ti)
+		coarseners.push_back(unique_ptr<SliceCoarsener>(new SliceCoarsener(testWidth, testHeight, coarsen, coarsenFraction)));
+	vector<OccupancySlice> thresholdSlices(numThresholds);
+	vector<OccupancySlice> fineSlices(numThresholds);
+	int nextCoarseSlice = 0;
+	auto nextSlices = [&]() {
+		if (coarsen == 1)
+			return readSlices(thresholdSlices);
+
+		int numFine = 0;
+		for (; numFine < coarsen && readSlices(fineSlices); ++numFine)
+		{
+			reportUnreadable(fineSlices[0]);
+			StageTimer timer(stats.get(), RunStats::kCoarsen, nextCoarseSlice);
+			for (int ti = 0; ti < numThresholds; ++ti)
+				coarseners[ti]->Add(fineSlices[ti]);
+		}
+		if (numFine == 0)
+			return false;
+
+		StageTimer timer(stats.get(), RunStats::kCoarsen, nextCoarseSlice);
+		for (int ti = 0; ti < numThresholds; ++ti)
+			coarseners[ti]->Finish(nextCoarseSlice, thresholdSlices[ti]);
+		++nextCoarseSlice;
+		return true;
+	};
+
+	// Reads the stack again from the first slice, after a pass over all of it: from the cache, if the pass
+	// just wrote it
+	auto rewindStack = [&]() {
+		bool rereadCache = !cacheWriters.empty();
+		for (int ti = 0; ti < static_cast<int>(cacheWriters.size()); ++ti)
+		{
+			if (cacheWriters[ti]->IsOpen() && !cacheWriters[ti]->Commit())
+				cout << "Warning. Unable to write occupancy cache \"" << cacheFilenames[ti] << "\". Use --cache-dir or --no-cache." << endl;
+			rereadCache = rereadCache && cacheReaders[ti]->Open(cacheFilenames[ti], fingerprint, depth, thresholds[ti], negateArg);
+		}
+		if (rereadCache)
+			pipeline.reset();
+		if (pipeline)
+			pipeline->Seek(0);
+		for (int ti = 0; ti < numThresholds; ++ti)
+			cacheReaders[ti]->Seek(0);
+		nextCoarseSlice = 0;
+	};
+
+	// With --keep-largest or --min-component-size, a first pass over the stack finds the connected
+	// components of each threshold, and the meshing pass drops those that aren't kept as it reads
+	// the stack again (from the cache, if the first pass just wrote it)
+	vector<unique_ptr<ComponentFilter> > componentFilters;
+	if (filterComponents)
+	{
+		for (int ti = 0; ti < numThresholds; ++ti)
+			componentFilters.push_back(unique_ptr<ComponentFilter>(new ComponentFilter));
+
+		if (!silentArg)
+			cout << "Finding connected components" << endl;
+		prePass = true;
+		while (nextSlices())
+		{
+			StageTimer timer(stats.get(), RunStats::kComponents, thresholdSlices[0].z);
+			for (int ti = 0; ti < numThresholds; ++ti)
+				componentFilters[ti]->AddSlice(thresholdSlices[ti]);
+		}
+		prePass = false;
+
+		for (int ti = 0; ti < numThresholds; ++ti)
+		{
+			ComponentFilter& filter = *componentFilters[ti];
+			filter.SelectComponents(minComponentSize, keepLargest);
+			if (silentArg)
+				continue;
+			if (sweep)
+				cout << "Threshold " << thresholds[ti] << ": ";
+			cout << "Keeping " << filter.GetNumKept() << " of " << filter.GetNumComponents() << " connected components ("
+				 << filter.GetVoxelsDropped() << " voxels dropped)" << endl;
+		}
+		rewindStack();
+	}
+
+	// With --partitions, a pass over the stack (without the components that are dropped) counts where the
+	// elements will be, and the partitions the lattice is cut into are the groups
+	unique_ptr<DomainPartitioner> partitioner;
+	if (partition)
+	{
+		partitioner.reset(new DomainPartitioner(numPartitions, meshWidth, meshHeight, meshDepth, static_cast<float>(coarsen),
+												outputFilenameIndices + ".partition"));
+		if (!silentArg)
+			cout << "Partitioning the lattice" << endl;
+		prePass = true;
+		while (nextSlices())
+		{
+			if (reportUnreadable(thresholdSlices[0]))
+				continue;
+			if (filterComponents)
+			{
+				StageTimer timer(stats.get(), RunStats::kComponents, thresholdSlices[0].z);
+				componentFilters[0]->FilterSlice(thresholdSlices[0]);
+			}
+			StageTimer timer(stats.get(), RunStats::kPartition, thresholdSlices[0].z);
+			partitioner->AddSlice(thresholdSlices[0]);
+		}
+		prePass = false;
+		{
+			StageTimer timer(stats.get(), RunStats::kPartition);
+			partitioner->Bisect();
+		}
+		groupBoxes = partitioner->GetBoxes();
+
+		if (filterComponents)
+			componentFilters[0]->Rewind();
+		rewindStack();
+	}
+
+	const int numGroups = groupBoxes.size();
+
+	// Every threshold meshes every group: mesh k is group k % numGroups of threshold k / numGroups
+	const int numMeshes = numThresholds * numGroups;
+
+	// The lattice is keyed by integer (x, y, z), so each group only needs two planes of node IDs,
+	// and only over the part of the image its box can reach. A cache hit also gives the foreground
+	// bounds of the whole stack, and no voxel outside them is ever meshed.
+	BoxGroups groups(groupBoxes, meshWidth, meshHeight);
+	vector<LatticeNodePool> nodePools;
+	vector<unique_ptr<SurfaceMesher> > surfaces;   // with --surface, each mesh's boundary faces instead, pooling their own nodes
+	for (int k = 0; k < numMeshes; ++k)
+	{
+		const int gi = k % numGroups;
+		int x0, y0, width, height;
+		groups.GetFootprint(gi, x0, y0, width, height);
+		int minX, minY, maxX, maxY;
+		if (cacheHit && cacheReaders[k / numGroups]->GetBounds(minX, minY, maxX, maxY))
+		{
+			minX /= coarsen;
+			minY /= coarsen;
+			maxX /= coarsen;
+			maxY /= coarsen;
+			const int x1 = std::min(x0 + width, maxX + 1);
+			const int y1 = std::min(y0 + height, maxY + 1);
+			x0 = std::max(x0, minX);
+			y0 = std::max(y0, minY);
+			width = std::max(x1 - x0, 0);
+			height = std::max(y1 - y0, 0);
+		}
+		if (surface)
+		{
+			surfaces.push_back(unique_ptr<SurfaceMesher>(new SurfaceMesher(x0, y0, width, height, surfaceTriangles)));
+			surfaces.back()->SetSpacing(static_cast<float>(coarsen));
+		}
+		if (adaptive || surface)
+			width = height = 0;
+		nodePools.push_back(LatticeNodePool(x0, y0, width, height));
+		nodePools.back().SetSpacing(static_cast<float>(coarsen));
+	}
+	if (surface)
+	{
+		meshFormat->SetNodesPerElement(surfaceTriangles ? 3 : 4);
+		outputFormat->SetNodesPerElement(surfaceTriangles ? 3 : 4);
+	}
+
+	// With --adaptive, each mesh is an octree of merged blocks instead, with nodes on the same lattice
+	vector<unique_ptr<OctreeMesher> > octrees;
+	for (int k = 0; k < numMeshes && adaptive; ++k)
+	{
+		octrees.push_back(unique_ptr<OctreeMesher>(new OctreeMesher(meshWidth, meshHeight, adaptiveLevel)));
+		octrees.back()->SetSpacing(static_cast<float>(coarsen));
+	}
+
+	// A resumed run picks up the node pools, element counts and output lengths of the last checkpoint.
+	// An octree holds slabs of slices that aren't meshed yet, a surface the faces on top of its last
+	// slice, and a partitioner the nodes on its shared faces, which a checkpoint doesn't capture.
+	const int checkpointEvery = (adaptive || surface || partition) ? 0 : vm["checkpoint-every"].as<int>();
+	const string checkpointFilename = outputFilenameIndices + ".checkpoint";
+	CheckpointHeader checkpoint = MakeCheckpointHeader(testWidth, testHeight, depth, numMeshes, thresholds[0], negateArg, fingerprint,
+													   CheckpointSettingsHash(vm["format"].as<string>(), thresholds,
+																			  coarsen, coarsenFraction, groupBoxes,
+																			  minComponentSize, keepLargest, renumberArg));
+	vector<CheckpointGroup> checkpointGroups(numMeshes);
+	if (resumeArg)
+	{
+		if (!ReadCheckpoint(checkpointFilename, checkpoint, checkpointGroups, nodePools))
+		{
+			cout << "Error. No checkpoint of a run with these inputs and options in \"" << checkpointFilename << "\"" << endl;
+			return 1;
+		}
+		if (!silentArg)
+			cout << "Resuming from slice " << (checkpoint.nextSlice + 1) << " of " << meshDepth << endl;
+	}
+
+	const string outputFilenameConstraints = vm["c"].as<string>();
+	vector<ofstream> fileNodes, fileIndices, fileConstraints;
+	vector<string> nodesFilenames, indicesFilenames, constraintsFilenames;
+	vector<string> runNodesFilenames, runIndicesFilenames, runConstraintsFilenames;   // the files the run writes
+	for (int k = 0; k < numMeshes; ++k)
+	{
+		const int gi = k % numGroups;
+		stringstream nodesNameSS, indicesNameSS, constraintsNameSS;
+		nodesNameSS   << outputFilenameNodes;
+		indicesNameSS << outputFilenameIndices;
+		constraintsNameSS << outputFilenameConstraints;
+		if (sweep)
+		{
+			nodesNameSS   << "_t" << thresholds[k / numGroups] << "_";
+			indicesNameSS << "_t" << thresholds[k / numGroups] << "_";
+			constraintsNameSS << "_t" << thresholds[k / numGroups] << "_";
+		}
+		nodesNameSS   << gi << outputFormat->GetFileExtension() << ends;
+		indicesNameSS << gi << outputFormat->GetFileExtension() << ends;
+		constraintsNameSS << gi << outputFormat->GetFileExtension() << ends;
+		nodesFilenames.push_back(nodesNameSS.str().c_str());
+		indicesFilenames.push_back(indicesNameSS.str().c_str());
+		constraintsFilenames.push_back(constraintsNameSS.str().c_str());
+		runNodesFilenames.push_back(nodesFilenames.back() + (renumber ? ".unsorted" : ""));
+		runIndicesFilenames.push_back(indicesFilenames.back() + (renumber ? ".unsorted" : ""));
+		runConstraintsFilenames.push_back(constraintsFilenames.back() + (renumber ? ".unsorted" : ""));
+
+		if (resumeArg)
+		{
+			// Drop whatever was written after the checkpoint, then append
+			boost::system::error_code ec;
+			fs::resize_file(fs::path(runNodesFilenames.back()), checkpointGroups[k].nodesBytes, ec);
+			if (!ec)
+				fs::resize_file(fs::path(runIndicesFilenames.back()), checkpointGroups[k].indicesBytes, ec);
+			if (ec)
+			{
+				cout << "Error. Unable to resume the output files of group " << gi << ": " << ec.message() << endl;
+				return 1;
+			}
+			fileNodes.push_back(ofstream(runNodesFilenames.back().c_str(),   meshFormat->GetOpenMode() | ios::in));
+			fileIndices.push_back(ofstream(runIndicesFilenames.back().c_str(), meshFormat->GetOpenMode() | ios::in));
+			fileNodes.back().seekp(0, ios::end);
+			fileIndices.back().seekp(0, ios::end);
+		}
+		else
+		{
+			fileNodes.push_back(ofstream(runNodesFilenames.back().c_str(),   meshFormat->GetOpenMode()));
+			fileIndices.push_back(ofstream(runIndicesFilenames.back().c_str(), meshFormat->GetOpenMode()));
+		}
+
+		if (!fileNodes.back().good() && !silentArg)
+		{
+			cout << "Failed to open nodes output file." << endl;
+			return 1;
+		}
+
+		if (!fileIndices.back().good() && !silentArg)
+		{
+			cout << "Failed to open indices output file." << endl;
+			return 1;
+		}
+
+		if (!resumeArg)
+		{
+			meshFormat->BeginNodes(fileNodes.back());
+			meshFormat->BeginIndices(fileIndices.back());
+		}
+
+		if (adaptive)
+		{
+			fileConstraints.push_back(ofstream(runConstraintsFilenames.back().c_str(), meshFormat->GetOpenMode()));
+			if (!fileConstraints.back().good() && !silentArg)
+			{
+				cout << "Failed to open constraints output file." << endl;
+				return 1;
+			}
+			meshFormat->BeginConstraints(fileConstraints.back());
+		}
+	}
+
+	vector<uint64_t> voxelCounts(numThresholds, 0);  // element IDs are 64-bit, like node IDs
+	vector<uint64_t> groupElementCounts(numMeshes, 0);
+	vector<uint64_t> groupConstraintCounts(numMeshes, 0);
+
+	// Writes what an octree or surface has meshed since the last call: elements (numbered on from
+	// the threshold's last element), then new nodes
+	auto writeMesherOutput = [&](const int k, auto& mesher, const int sliceCount) {
+		const int ti = k / numGroups;
+		const vector<VertIdType>& elements = mesher.GetElements();
+		if (!elements.empty())
+		{
+			const size_t numElements = elements.size() / meshFormat->GetNodesPerElement();
+			string block = writer.AcquireBlock();
+			{
+				StageTimer timer(stats.get(), RunStats::kFormat, sliceCount);
+				meshFormat->AppendElements(block, voxelCounts[ti] + 1, elements.data(), numElements);
+			}
+			writer.Write(fileIndices[k], std::move(block));
+			voxelCounts[ti] += numElements;
+			groupElementCounts[k] += numElements;
+			mesher.ClearElements();
+		}
+
+		const vector<Vec3>& nodes = mesher.GetPendingNodes();
+		if (!nodes.empty())
+		{
+			string block = writer.AcquireBlock();
+			{
+				StageTimer timer(stats.get(), RunStats::kFormat, sliceCount);
+				meshFormat->AppendNodes(block, mesher.GetFirstPendingId(), nodes.data(), nodes.size());
+			}
+			writer.Write(fileNodes[k], std::move(block));
+			mesher.ClearPendingNodes();
+		}
+	};
+
+	// An octree's elements and nodes, then its hanging nodes
+	auto writeOctreeOutput = [&](const int k, const int sliceCount) {
+		OctreeMesher& octree = *octrees[k];
+		writeMesherOutput(k, octree, sliceCount);
+
+		const vector<VertIdType>& constraints = octree.GetConstraints();
+		if (!constraints.empty())
+		{
+			const size_t numConstraints = constraints.size() / kConstraintValues;
+			string block = writer.AcquireBlock();
+			{
+				StageTimer timer(stats.get(), RunStats::kFormat, sliceCount);
+				meshFormat->AppendConstraints(block, constraints.data(), numConstraints);
+			}
+			writer.Write(fileConstraints[k], std::move(block));
+			groupConstraintCounts[k] += numConstraints;
+			octree.ClearConstraints();
+		}
+	};
+
+	if (resumeArg)
+	{
+		if (filterComponents)
+		{
+			// A slice's labels depend on every slice before it, so the slices before the checkpoint are labelled
+			// again rather than skipped
+			for (int z = 0; z < static_cast<int>(checkpoint.nextSlice) && nextSlices(); ++z)
+			{
+				StageTimer timer(stats.get(), RunStats::kComponents, z);
+				for (int ti = 0; ti < numThresholds; ++ti)
+					componentFilters[ti]->FilterSlice(thresholdSlices[ti]);
+			}
+		}
+		else
+		{
+			nextCoarseSlice = static_cast<int>(checkpoint.nextSlice);
+			if (pipeline)
+				pipeline->Seek(static_cast<int>(checkpoint.nextSlice) * coarsen);
+			for (int ti = 0; ti < numThresholds; ++ti)
+				cacheReaders[ti]->Seek(static_cast<int>(checkpoint.nextSlice) * coarsen);
+		}
+		for (int k = 0; k < numMeshes; ++k)
+		{
+			groupElementCounts[k] = checkpointGroups[k].elementCount;
+			voxelCounts[k / numGroups] += groupElementCounts[k];
+		}
+	}
+	bool checkpointFailed = false;
+	bool faceNodesAdded = true;     // with --partitions, every node on a shared face went to the partitioner
+	vector<vector<VertIdType> > groupSliceElements(numMeshes);    // per mesh, 8 node IDs per element, in output order
+	vector<int> segmentRuns;    // (begin, end) pairs of foreground runs in the current row segment
+	vector<OccupancySlice> groupSlices((adaptive || surface) ? numGroups : 0);  // per group, the slice's voxels in the group
+	while (nextSlices())
+	{
+		const int sliceCount = thresholdSlices[0].z;
+		TraceScope sliceScope(trace.get(), "slice", sliceCount);
 
-		BMP bmp;
-		if (!bmp.ReadFromFile(str->generic_string().c_str()))
+		// Every slice before this one is meshed, its nodes are pending no more, and once the writer
+		// is flushed all of its output is in the files
+		if (checkpointEvery > 0 && sliceCount % checkpointEvery == 0 && sliceCount > static_cast<int>(checkpoint.nextSlice))
 		{
-			cout << "Error reading bitmap. Filename = \"" << *str << "\"" << endl;
+			writer.Flush();
+			checkpoint.elementCount = 0;
+			for (int k = 0; k < numMeshes; ++k)
+			{
+				fileNodes[k].flush();
+				fileIndices[k].flush();
+				checkpointGroups[k].nodesBytes = static_cast<uint64_t>(fileNodes[k].tellp());
+				checkpointGroups[k].indicesBytes = static_cast<uint64_t>(fileIndices[k].tellp());
+				checkpointGroups[k].elementCount = groupElementCounts[k];
+				checkpoint.elementCount += groupElementCounts[k];
+			}
+			checkpoint.nextSlice = sliceCount;
+			if (!WriteCheckpoint(checkpointFilename, checkpoint, checkpointGroups, nodePools) && !checkpointFailed)
+			{
+				checkpointFailed = true;
+				if (!silentArg)
+					cout << "Warning. Unable to write checkpoint \"" << checkpointFilename << "\"" << endl;
+			}
+		}
+
+		if (!silentArg && sliceCount % 100 == 99)
+			cout << "Processing slice " << (sliceCount+1) << " of " << meshDepth << endl;
+
+		if (reportUnreadable(thresholdSlices[0]))
 			continue;
+
+		if (filterComponents)
+		{
+			StageTimer timer(stats.get(), RunStats::kComponents, sliceCount);
+			for (int ti = 0; ti < numThresholds; ++ti)
+				componentFilters[ti]->FilterSlice(thresholdSlices[ti]);
 		}
-		
-		for (int gi = 0; gi < groupBoxes.size(); ++gi)
+
+		// Each threshold meshes its own slice into its own groups, one threshold after another
+		groups.BeginSlice(sliceCount);
+		for (int ti = 0; ti < numThresholds; ++ti)
 		{
-			VertPool<SIMPLE_VERTEX>& vertPool = vertPools[gi];
-			const AABox& box = groupBoxes[gi];
-			ofstream& fileInds = fileIndices[gi];
-			for (int y = 0; y < bmp.TellHeight(); ++y)
+			const OccupancySlice& slice = thresholdSlices[ti];
+			LatticeNodePool* const pools = &nodePools[ti * numGroups];
+			vector<VertIdType>* const sliceElementsOf = &groupSliceElements[ti * numGroups];
+			const int firstMesh = ti * numGroups;
+
+			// An octree is given each group's part of the slice, and meshes it a slab at a time.
+			// A surface meshes it straight away, apart from the faces on top of it.
+			if (adaptive || surface)
+			{
+				if (!slice.IsEmpty())
+				{
+					StageTimer timer(stats.get(), RunStats::kMesh, sliceCount);
+					for (int gi = 0; gi < numGroups; ++gi)
+					{
+						groupSlices[gi].Resize(slice.GetWidth(), slice.GetHeight());
+						groupSlices[gi].z = sliceCount;
+					}
+
+					int minX, minY, maxX, maxY;
+					slice.GetBounds(minX, minY, maxX, maxY);
+					for (int y = minY; y <= maxY; ++y)
+					{
+						const vector<BoxGroups::Segment>& segments = groups.GetRowSegments(y);
+						for (auto segment = segments.begin(); segment != segments.end(); ++segment)
+						{
+							const int* segmentGroups = groups.GetGroups() + segment->firstGroup;
+							for (int i = 0; i < segment->numGroups; ++i)
+								groupSlices[segmentGroups[i]].CopyBits(slice, y, segment->begin, segment->end);
+						}
+					}
+
+					for (int gi = 0; gi < numGroups; ++gi)
+					{
+						groupSlices[gi].UpdateSummary();
+						if (!groups.IsInSlice(gi) || groupSlices[gi].IsEmpty())
+							continue;
+						if (adaptive)
+							octrees[firstMesh + gi]->AddSlice(groupSlices[gi]);
+						else
+							surfaces[firstMesh + gi]->AddSlice(groupSlices[gi]);
+					}
+				}
+
+				for (int gi = 0; gi < numGroups; ++gi)
+				{
+					if (adaptive)
+						writeOctreeOutput(firstMesh + gi, sliceCount);
+					else
+						writeMesherOutput(firstMesh + gi, *surfaces[firstMesh + gi], sliceCount);
+				}
+				continue;
+			}
+
+			// An empty slice creates no nodes or elements. The pools notice the gap at the next BeginSlice().
+			if (slice.IsEmpty())
+				continue;
+
 			{
-				for (int x = 0; x < bmp.TellWidth(); ++x)
+				StageTimer timer(stats.get(), RunStats::kMesh, sliceCount);
+
+				// Each row is scanned once. The foreground runs of a segment go to every group the segment is in.
+				for (int gi = 0; gi < numGroups; ++gi)
+				{
+					if (groups.IsInSlice(gi))
+						pools[gi].BeginSlice(sliceCount);
+				}
+
+				// Only rows within the slice's foreground bounds are visited, whole tiles of background rows
+				// are stepped over, and each row's segments are clipped to the words that hold its foreground
+				int minX, minY, maxX, maxY;
+				slice.GetBounds(minX, minY, maxX, maxY);
+				for (int y = minY; y <= maxY; ++y)
 				{
-					const short pix = PixColourAsShort(bmp(x,  y));
-					if ((pix > threshold) || (negateArg && (pix < threshold)))
+					if (slice.IsTileRowEmpty(y / OccupancySlice::kTileSize))
+					{
+						y = (y / OccupancySlice::kTileSize + 1) * OccupancySlice::kTileSize - 1;
+						continue;
+					}
+
+					const int rowBegin = 64 * slice.GetRowFirstWord(y);
+					const int rowEnd = std::min(64 * slice.GetRowEndWord(y), slice.GetWidth());
+					if (rowBegin >= rowEnd)
+						continue;
+
+					const vector<BoxGroups::Segment>& segments = groups.GetRowSegments(y);
+					for (auto segment = segments.begin(); segment != segments.end(); ++segment)
 					{
-						const SIMPLE_VERTEX verts[8] = {SIMPLE_VERTEX(IndexToVert(x,   y,   sliceCount)),
-														SIMPLE_VERTEX(IndexToVert(x+1, y,   sliceCount)),
-														SIMPLE_VERTEX(IndexToVert(x,   y+1, sliceCount)),
-														SIMPLE_VERTEX(IndexToVert(x+1, y+1, sliceCount)),
-														SIMPLE_VERTEX(IndexToVert(x,   y,   sliceCount+1)),
-														SIMPLE_VERTEX(IndexToVert(x+1, y,   sliceCount+1)),
-														SIMPLE_VERTEX(IndexToVert(x,   y+1, sliceCount+1)),
-														SIMPLE_VERTEX(IndexToVert(x+1, y+1, sliceCount+1))};
-						
-						if (!IsInAABox(verts[0].pos, groupBoxes[gi]))
+						const int begin = std::max(segment->begin, rowBegin);
+						const int end = std::min(segment->end, rowEnd);
+						if (begin >= end)
 							continue;
 
-						VertIdType indices[8] = { vertPool.AddVertRef(verts[0]),	// 1
-												  vertPool.AddVertRef(verts[1]),	// 2
-												  vertPool.AddVertRef(verts[2]),	// 3
-												  vertPool.AddVertRef(verts[3]),	// 4
-												  vertPool.AddVertRef(verts[4]),	// 5
-												  vertPool.AddVertRef(verts[5]),	// 6
-												  vertPool.AddVertRef(verts[6]),	// 7
-												  vertPool.AddVertRef(verts[7])};	// 8
-						fileInds << "\t" << (voxelCount+1) << sep << (1+indices[0]) << sep <<
-																	 (1+indices[1]) << sep <<
-																	 (1+indices[3]) << sep <<
-																	 (1+indices[2]) << sep <<
-																	 (1+indices[4]) << sep <<
-																	 (1+indices[5]) << sep <<
-																	 (1+indices[7]) << sep <<
-																	 (1+indices[6]) << endl;
-						++voxelCount;
+						segmentRuns.clear();
+						slice.AppendRuns(y, begin, end, segmentRuns);
+						if (segmentRuns.empty())
+							continue;
+
+						const int* segmentGroups = groups.GetGroups() + segment->firstGroup;
+						for (int i = 0; i < segment->numGroups; ++i)
+						{
+							const int gi = segmentGroups[i];
+							for (size_t r = 0; r < segmentRuns.size(); r += 2)
+								pools[gi].AppendRunElements(segmentRuns[r], segmentRuns[r + 1], y, sliceElementsOf[gi]);
+						}
 					}
 				}
 			}
+
+			// Element IDs are handed out group by group, as when each group scanned the slice in turn
+			for (int gi = 0; gi < numGroups; ++gi)
+			{
+				vector<VertIdType>& sliceElements = sliceElementsOf[gi];
+				const size_t numElements = sliceElements.size() / 8;
+				if (numElements == 0)
+					continue;
+
+				string block = writer.AcquireBlock();
+				{
+					StageTimer timer(stats.get(), RunStats::kFormat, sliceCount);
+					meshFormat->AppendElements(block, voxelCounts[ti] + 1, sliceElements.data(), numElements);
+				}
+				writer.Write(fileIndices[firstMesh + gi], std::move(block));
+				voxelCounts[ti] += numElements;
+				groupElementCounts[firstMesh + gi] += numElements;
+				sliceElements.clear();
+			}
+
+			// Nodes are final as soon as they're created, so only this slice's new nodes are held in memory
+			for (int gi = 0; gi < numGroups; ++gi)
+			{
+				LatticeNodePool& nodePool = pools[gi];
+				const vector<Vec3>& nodes = nodePool.GetPendingNodes();
+				if (nodes.empty())
+					continue;
+
+				string block = writer.AcquireBlock();
+				{
+					StageTimer timer(stats.get(), RunStats::kFormat, sliceCount);
+					meshFormat->AppendNodes(block, nodePool.GetFirstPendingId(), nodes.data(), nodes.size());
+				}
+				writer.Write(fileNodes[firstMesh + gi], std::move(block));
+				if (partitioner)
+				{
+					StageTimer timer(stats.get(), RunStats::kPartition, sliceCount);
+					faceNodesAdded = partitioner->AddNodes(gi, nodePool.GetFirstPendingId(), nodes.data(), nodes.size()) && faceNodesAdded;
+				}
+				nodePool.ClearPendingNodes();
+			}
 		}
 	}
 
-	for (int gi = 0; gi < groupBoxes.size(); ++gi)
+	// The last slabs of each octree are only meshed once the stack has run out
+	for (int k = 0; k < static_cast<int>(octrees.size()); ++k)
 	{
-		fileIndices[gi].flush();
-		fileIndices[gi].close();
+		{
+			StageTimer timer(stats.get(), RunStats::kMesh, meshDepth);
+			octrees[k]->Finish();
+		}
+		writeOctreeOutput(k, meshDepth);
 	}
 
-	for (int i = 0; i < vertPools.size(); ++i)
+	// and the top of each surface
+	for (int k = 0; k < static_cast<int>(surfaces.size()); ++k)
 	{
-		unsigned int nodeCount = 0;
-		const VertPool<SIMPLE_VERTEX>& vertPool = vertPools[i];
-		auto pooledVerts = vertPool.GetPooledVerts();
-		ofstream& fileNs = fileNodes[i];
-		for (auto v = pooledVerts.begin(); v != pooledVerts.end(); ++v, ++nodeCount)
 		{
-			fileNs << "\t" << (nodeCount+1) << sep << v->pos.x << sep << v->pos.y << sep << v->pos.z << endl;
+			StageTimer timer(stats.get(), RunStats::kMesh, meshDepth);
+			surfaces[k]->Finish();
 		}
-		fileNs.flush();
-		fileNs.close();
+		writeMesherOutput(k, *surfaces[k], meshDepth);
+	}
+
+	writer.Flush();
+
+	for (int ti = 0; ti < static_cast<int>(cacheWriters.size()); ++ti)
+	{
+		if (cacheWriters[ti]->IsOpen() && !cacheWriters[ti]->Commit())
+			cout << "Warning. Unable to write occupancy cache \"" << cacheFilenames[ti] << "\". Use --cache-dir or --no-cache." << endl;
+	}
+
+	for (int k = 0; k < numMeshes; ++k)
+	{
+		meshFormat->EndIndices(fileIndices[k], groupElementCounts[k]);
+		fileIndices[k].flush();
+		if (stats && !renumber)
+			stats->AddOutputFile(indicesFilenames[k], static_cast<uint64_t>(fileIndices[k].tellp()));
+		fileIndices[k].close();
+	}
+
+	uint64_t nodeCount = 0;
+	for (int k = 0; k < numMeshes; ++k)
+	{
+		uint64_t meshNodeCount = nodePools[k].GetNodeCount();
+		if (adaptive)
+			meshNodeCount = octrees[k]->GetNodeCount();
+		else if (surface)
+			meshNodeCount = surfaces[k]->GetNodeCount();
+		meshFormat->EndNodes(fileNodes[k], meshNodeCount);
+		fileNodes[k].flush();
+		if (stats && !renumber)
+			stats->AddOutputFile(nodesFilenames[k], static_cast<uint64_t>(fileNodes[k].tellp()));
+		fileNodes[k].close();
+		nodeCount += meshNodeCount;
+	}
+
+	for (int k = 0; k < static_cast<int>(fileConstraints.size()); ++k)
+	{
+		meshFormat->EndConstraints(fileConstraints[k], groupConstraintCounts[k]);
+		fileConstraints[k].flush();
+		if (stats && !renumber)
+			stats->AddOutputFile(constraintsFilenames[k], static_cast<uint64_t>(fileConstraints[k].tellp()));
+		fileConstraints[k].close();
+	}
+
+	// Once every partition is meshed, the nodes on their shared faces are matched up into their interface maps
+	if (partitioner)
+	{
+		vector<string> interfaceFilenames;
+		vector<uint64_t> partitionNodeCounts;
+		for (int gi = 0; gi < numGroups; ++gi)
+		{
+			stringstream interfaceNameSS;
+			interfaceNameSS << vm["m"].as<string>() << gi << meshFormat->GetFileExtension();
+			interfaceFilenames.push_back(interfaceNameSS.str());
+			partitionNodeCounts.push_back(nodePools[gi].GetNodeCount());
+		}
+		bool written;
+		{
+			StageTimer timer(stats.get(), RunStats::kPartition, meshDepth);
+			written = partitioner->WriteInterfaces(partitionNodeCounts, *meshFormat, interfaceFilenames) && faceNodesAdded;
+		}
+		if (!written)
+		{
+			cout << "Error. Unable to write the interface maps of the partitions to \"" << interfaceFilenames[0] << "\" and on" << endl;
+			return 1;
+		}
+
+		for (int gi = 0; gi < numGroups; ++gi)
+		{
+			if (stats)
+			{
+				boost::system::error_code ignored;
+				stats->AddOutputFile(interfaceFilenames[gi], static_cast<uint64_t>(fs::file_size(fs::path(interfaceFilenames[gi]), ignored)));
+				stats->AddPartition(gi, groupElementCounts[gi], partitionNodeCounts[gi], partitioner->GetInterfaceNodeCount(gi),
+									partitioner->GetFirstGlobalId(gi) + meshFormat->GetFirstNodeId());
+			}
+			if (!silentArg)
+				cout << "Partition " << gi << ": " << groupElementCounts[gi] << " elements, " << partitionNodeCounts[gi] << " nodes, "
+					 << partitioner->GetInterfaceNodeCount(gi) << " interface nodes" << endl;
+		}
+	}
+
+	// Each mesh is renumbered from the files the run wrote into the output files. Elements keep the IDs
+	// they had over the groups of their threshold, a group's coming after those of the groups before it.
+	// The run's files and checkpoint are kept until every mesh is renumbered, so that a run stopped while
+	// renumbering can be resumed.
+	const MeshRenumberer::Order renumberOrder = (renumberArg == "hilbert") ? MeshRenumberer::kHilbert :
+												(renumberArg == "rcm") ? MeshRenumberer::kRcm : MeshRenumberer::kMorton;
+	uint64_t renumberedElements = 0;
+	for (int k = 0; k < numMeshes && renumber; ++k)
+	{
+		const int ti = k / numGroups;
+		const int gi = k % numGroups;
+		if (gi == 0)
+			renumberedElements = 0;
+
+		MeshRenumberer renumberer(renumberOrder, static_cast<float>(coarsen), static_cast<size_t>(vm["renumber-memory"].as<int>()) << 20);
+		ofstream nodesOut(nodesFilenames[k].c_str(), outputFormat->GetOpenMode());
+		ofstream indicesOut(indicesFilenames[k].c_str(), outputFormat->GetOpenMode());
+		ofstream constraintsOut;
+		if (adaptive)
+			constraintsOut.open(constraintsFilenames[k].c_str(), outputFormat->GetOpenMode());
+		bool renumbered;
+		{
+			StageTimer timer(stats.get(), RunStats::kRenumber);
+			renumbered = nodesOut.good() && indicesOut.good() && (!adaptive || constraintsOut.good()) &&
+						 renumberer.Renumber(runNodesFilenames[k], runIndicesFilenames[k], adaptive ? runConstraintsFilenames[k] : "",
+											 *outputFormat, nodesOut, indicesOut, &constraintsOut, renumberedElements + 1, runIndicesFilenames[k]);
+			nodesOut.flush();
+			indicesOut.flush();
+			constraintsOut.flush();
+		}
+		if (!renumbered || !nodesOut.good() || !indicesOut.good() || (adaptive && !constraintsOut.good()))
+		{
+			cout << "Error. Unable to renumber the mesh of group " << gi << " from \"" << runNodesFilenames[k] << "\"" << endl;
+			return 1;
+		}
+		renumberedElements += renumberer.GetElementCount();
+
+		if (stats)
+		{
+			stats->AddOutputFile(indicesFilenames[k], static_cast<uint64_t>(indicesOut.tellp()));
+			stats->AddOutputFile(nodesFilenames[k], static_cast<uint64_t>(nodesOut.tellp()));
+			if (adaptive)
+				stats->AddOutputFile(constraintsFilenames[k], static_cast<uint64_t>(constraintsOut.tellp()));
+			stats->AddRenumbering(thresholds[ti], gi, renumberer.GetBandBefore(), renumberer.GetBandAfter());
+		}
+		if (!silentArg)
+		{
+			if (sweep)
+				cout << "Threshold " << thresholds[ti] << ", ";
+			const MeshRenumberer::Band& before = renumberer.GetBandBefore();
+			const MeshRenumberer::Band& after = renumberer.GetBandAfter();
+			cout << (sweep ? "group " : "Group ") << gi << " renumbered: bandwidth " << before.bandwidth << " -> " << after.bandwidth
+				 << ", profile " << before.profile << " -> " << after.profile
+				 << ", median element span under " << before.medianSpan << " -> " << after.medianSpan << endl;
+		}
+	}
+
+	// The output is complete, so there is nothing to resume
+	{
+		boost::system::error_code ignored;
+		fs::remove(fs::path(checkpointFilename), ignored);
+		for (int k = 0; k < numMeshes && renumber; ++k)
+		{
+			fs::remove(fs::path(runNodesFilenames[k]), ignored);
+			fs::remove(fs::path(runIndicesFilenames[k]), ignored);
+			if (adaptive)
+				fs::remove(fs::path(runConstraintsFilenames[k]), ignored);
+		}
+	}
+
+	if (stats && vm.count("stats"))
+	{
+		uint64_t elementCount = 0;
+		for (int k = 0; k < numMeshes; ++k)
+		{
+			if (!adaptive && !surface)
+				stats->AddNodePool(thresholds[k / numGroups], k % numGroups, nodePools[k].GetPlaneSize(),
+								   nodePools[k].GetPlaneSize() * nodePools[k].GetPlaneEntryBytes(), nodePools[k].GetNodeCount(), meshDepth + 1);
+			elementCount += groupElementCounts[k];
+		}
+		stats->SetCounts(numThreads, depth, static_cast<uint64_t>(testWidth) * testHeight * depth, elementCount, nodeCount);
+
+		const string statsFilename = vm["stats"].as<string>();
+		if (statsFilename == "-")
+			stats->WriteJson(cout);
+		else
+		{
+			ofstream statsFile(statsFilename.c_str());
+			stats->WriteJson(statsFile);
+			if (!statsFile.good() && !silentArg)
+				cout << "Warning. Unable to write stats file \"" << statsFilename << "\"" << endl;
+		}
+	}
+
+	// Every slice has been handed out and the writer is flushed, so no thread is still recording
+	if (trace)
+	{
+		const string traceFilename = vm["trace"].as<string>();
+		ofstream traceFile(traceFilename.c_str());
+		trace->WriteJson(traceFile);
+		if (!traceFile.good() && !silentArg)
+			cout << "Warning. Unable to write trace file \"" << traceFilename << "\"" << endl;
 	}
 
 	if (!silentArg)